@@ -0,0 +1,12 @@
+message("-- Configuring SENSEI, if appropriate...")
+if (USE_SENSEI)
+    find_package(SENSEI REQUIRED)
+    if (NOT SENSEI_FOUND)
+        #do nothing
+        message(FATAL_ERROR "SENSEI not found!")
+    endif()
+endif()
+
+function(set_sensei)
+    target_link_libraries(${PROJECT_NAME} sensei)
+endfunction()
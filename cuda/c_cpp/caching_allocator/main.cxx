@@ -0,0 +1,502 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Caching allocator with size classes and per-stream free lists (CUDA and host backends)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <map>
+#include <vector>
+#include <unordered_map>
+#include <sys/mman.h>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <cuda_runtime.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+// Define the array size
+#define SIZE 3
+
+// Size classes: powers of two from 2^MIN_CLASS_LOG2 to 2^MAX_CLASS_LOG2 bytes
+#define MIN_CLASS_LOG2 8
+#define MAX_CLASS_LOG2 20
+#define NUM_CLASSES (MAX_CLASS_LOG2 - MIN_CLASS_LOG2 + 1)
+
+// Large requests are carved from segments rounded to this size
+#define LARGE_ROUND (2ul << 20)
+
+/**
+ * @brief Simple struct containing an int and a float dynamic array
+ * @author Lucas Gasparino
+ */
+struct Basic
+{
+    int id;
+    float* value;
+};
+
+#ifndef NOACC
+// Device memory through the CUDA runtime
+struct CudaBackend
+{
+    typedef cudaStream_t Stream;
+    static const char* name() { return "cuda"; }
+    static void* alloc(size_t bytes) {
+        void* p = nullptr;
+        if (cudaMalloc(&p, bytes) != cudaSuccess) {
+            return nullptr;
+        }
+        return p;
+    }
+    static void release(void* p, size_t) { cudaFree(p); }
+};
+#endif
+
+// Host memory through malloc/free
+struct HostBackend
+{
+    typedef int Stream;
+    static const char* name() { return "malloc"; }
+    static void* alloc(size_t bytes) { return malloc(bytes); }
+    static void release(void* p, size_t) { free(p); }
+};
+
+// Host memory straight from the kernel (a syscall and page zeroing per call, like cudaMalloc)
+struct MmapBackend
+{
+    typedef int Stream;
+    static const char* name() { return "mmap"; }
+    static void* alloc(size_t bytes) {
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return (p == MAP_FAILED) ? nullptr : p;
+    }
+    static void release(void* p, size_t bytes) { munmap(p, bytes); }
+};
+
+// Allocator statistics
+struct AllocStats
+{
+    long requested;     // Bytes currently handed out, as requested
+    long reserved;      // Bytes currently obtained from the backend
+    long peakReserved;  // Maximum of reserved
+    long hits;          // Requests served from the cache
+    long misses;        // Requests that needed the backend
+    long backendAllocs; // Calls to Backend::alloc
+    long backendFrees;  // Calls to Backend::release
+    long splits;        // Large blocks split
+    long merges;        // Large blocks coalesced
+};
+
+/**
+ * @brief Caching allocator: freed blocks are kept and reused instead of being returned to the backend
+ *
+ * Small requests are rounded to a power-of-two size class and cached in per-stream free lists.
+ * Large requests are carved from backend segments: blocks are split on allocation and coalesced
+ * with free neighbours of the same segment on release. A block freed on a stream is only reused
+ * on that stream, so no cross-stream synchronization is needed.
+ */
+template <class Backend>
+class CachingAllocator
+{
+    private:
+        typedef typename Backend::Stream Stream;
+
+        // Large block inside a backend segment (doubly linked with its neighbours)
+        struct Block
+        {
+            char* ptr;       // Start address
+            size_t size;     // Block size
+            size_t segSize;  // Size of the owning segment (valid for the segment head)
+            bool free;       // Cached (true) or handed out (false)
+            bool segHead;    // First block of its segment
+            Stream stream;   // Stream the block belongs to
+            Block* prev;     // Lower-address neighbour in the segment
+            Block* next;     // Higher-address neighbour in the segment
+        };
+
+        // Information on a handed-out pointer
+        struct Live
+        {
+            size_t requested; // Requested size
+            int cls;          // Size class, -1 for large blocks
+            Stream stream;    // Stream it was allocated on
+            Block* block;     // Large block, nullptr for small ones
+        };
+
+        std::map<Stream, std::vector<void*>> smallFree[NUM_CLASSES]; // Per class, per stream
+        std::map<Stream, std::multimap<size_t, Block*>> largeFree;   // Per stream, by size
+        std::unordered_map<void*, Live> live;                        // Handed-out pointers
+        AllocStats st;
+
+        static int sizeClass(size_t bytes) {
+            int c = 0;
+            while (((size_t)1 << (MIN_CLASS_LOG2 + c)) < bytes) {
+                ++c;
+            }
+            return c;
+        }
+
+        void* backendAlloc(size_t bytes) {
+            void* p = Backend::alloc(bytes);
+            if (!p) {
+                // Out of memory: give the cache back and retry once
+                trim();
+                p = Backend::alloc(bytes);
+            }
+            if (p) {
+                st.backendAllocs += 1;
+                st.reserved += bytes;
+                if (st.reserved > st.peakReserved) {
+                    st.peakReserved = st.reserved;
+                }
+            }
+            return p;
+        }
+
+        void backendRelease(void* p, size_t bytes) {
+            Backend::release(p, bytes);
+            st.backendFrees += 1;
+            st.reserved -= bytes;
+        }
+
+        void eraseFree(Block* b) {
+            auto& m = largeFree[b->stream];
+            auto range = m.equal_range(b->size);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == b) {
+                    m.erase(it);
+                    return;
+                }
+            }
+        }
+
+        void* allocLarge(size_t bytes, Stream s) {
+            const size_t size = (bytes + 511) & ~(size_t)511; // Keep blocks 512-byte aligned
+            auto& m = largeFree[s];
+            auto it = m.lower_bound(size); // Best fit
+            Block* b = nullptr;
+            if (it != m.end()) {
+                b = it->second;
+                m.erase(it);
+                st.hits += 1;
+            } else {
+                const size_t segSize = (size + LARGE_ROUND - 1) / LARGE_ROUND * LARGE_ROUND;
+                char* p = (char*)backendAlloc(segSize);
+                if (!p) {
+                    return nullptr;
+                }
+                b = new Block{p, segSize, segSize, true, true, s, nullptr, nullptr};
+                st.misses += 1;
+            }
+            // Split off the tail if it is worth keeping
+            if (b->size - size >= ((size_t)1 << MAX_CLASS_LOG2)) {
+                Block* tail = new Block{b->ptr + size, b->size - size, 0, true, false, s, b, b->next};
+                if (b->next) {
+                    b->next->prev = tail;
+                }
+                b->next = tail;
+                b->size = size;
+                largeFree[s].insert(std::make_pair(tail->size, tail));
+                st.splits += 1;
+            }
+            b->free = false;
+            live[b->ptr] = Live{bytes, -1, s, b};
+            return b->ptr;
+        }
+
+        void freeLarge(Block* b) {
+            b->free = true;
+            // Coalesce with free neighbours (same segment, hence same stream)
+            if (b->next && b->next->free) {
+                Block* n = b->next;
+                eraseFree(n);
+                b->size += n->size;
+                b->next = n->next;
+                if (n->next) {
+                    n->next->prev = b;
+                }
+                delete n;
+                st.merges += 1;
+            }
+            if (b->prev && b->prev->free) {
+                Block* p = b->prev;
+                eraseFree(p);
+                p->size += b->size;
+                p->next = b->next;
+                if (b->next) {
+                    b->next->prev = p;
+                }
+                delete b;
+                b = p;
+                st.merges += 1;
+            }
+            largeFree[b->stream].insert(std::make_pair(b->size, b));
+        }
+    public:
+        CachingAllocator() {
+            memset(&st, 0, sizeof(st));
+        }
+
+        ~CachingAllocator() {
+            trim();
+        }
+
+        // Allocate bytes for use on stream s
+        void* allocate(size_t bytes, Stream s = Stream()) {
+            if (bytes == 0) {
+                bytes = 1;
+            }
+            void* p = nullptr;
+            if (bytes <= ((size_t)1 << MAX_CLASS_LOG2)) {
+                const int c = sizeClass(bytes);
+                std::vector<void*>& list = smallFree[c][s];
+                if (!list.empty()) {
+                    p = list.back();
+                    list.pop_back();
+                    st.hits += 1;
+                } else {
+                    p = backendAlloc((size_t)1 << (MIN_CLASS_LOG2 + c));
+                    st.misses += 1;
+                }
+                if (p) {
+                    live[p] = Live{bytes, c, s, nullptr};
+                }
+            } else {
+                p = allocLarge(bytes, s);
+            }
+            if (p) {
+                st.requested += bytes;
+            }
+            return p;
+        }
+
+        // Return a pointer to the cache (never to the backend)
+        void deallocate(void* p) {
+            auto it = live.find(p);
+            if (it == live.end()) {
+                return;
+            }
+            const Live l = it->second;
+            live.erase(it);
+            st.requested -= l.requested;
+            if (l.block) {
+                freeLarge(l.block);
+            } else {
+                smallFree[l.cls][l.stream].push_back(p);
+            }
+        }
+
+        // Give every cached small block and every fully free segment back to the backend
+        void trim() {
+            for (int c = 0; c < NUM_CLASSES; ++c) {
+                for (auto& kv : smallFree[c]) {
+                    for (void* p : kv.second) {
+                        backendRelease(p, (size_t)1 << (MIN_CLASS_LOG2 + c));
+                    }
+                    kv.second.clear();
+                }
+            }
+            for (auto& kv : largeFree) {
+                for (auto it = kv.second.begin(); it != kv.second.end();) {
+                    Block* b = it->second;
+                    if (b->segHead && !b->next && b->size == b->segSize) {
+                        backendRelease(b->ptr, b->segSize);
+                        delete b;
+                        it = kv.second.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+        }
+
+        const AllocStats& stats() const { return st; }
+
+        void printStats(const char* label) const {
+            printf("[%s/%s] requested %ld B, reserved %ld B (peak %ld B), hits %ld, misses %ld, "
+                   "backend allocs %ld, frees %ld, splits %ld, merges %ld\n",
+                   label, Backend::name(), st.requested, st.reserved, st.peakReserved, st.hits, st.misses,
+                   st.backendAllocs, st.backendFrees, st.splits, st.merges);
+        }
+};
+
+// Time-loop pattern on the host: every step allocates and frees the same set of buffers
+template <class Backend>
+void benchmarkHost(int nsteps, int nbuf)
+{
+    // Mix of small struct-like sizes and a few large arrays
+    std::vector<size_t> sizes(nbuf);
+    uint64_t seed = 42;
+    for (int b = 0; b < nbuf; ++b) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        sizes[b] = (b % 16 == 0) ? (size_t)(4u << 20) + (seed >> 44) : 16 + (seed >> 52);
+    }
+    std::vector<void*> ptrs(nbuf);
+
+    // Direct backend calls
+    auto t0 = std::chrono::steady_clock::now();
+    for (int step = 0; step < nsteps; ++step) {
+        for (int b = 0; b < nbuf; ++b) {
+            ptrs[b] = Backend::alloc(sizes[b]);
+            ((char*)ptrs[b])[0] = (char)step;
+        }
+        for (int b = 0; b < nbuf; ++b) {
+            Backend::release(ptrs[b], sizes[b]);
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    // Through the caching allocator
+    CachingAllocator<Backend> cache;
+    for (int step = 0; step < nsteps; ++step) {
+        for (int b = 0; b < nbuf; ++b) {
+            ptrs[b] = cache.allocate(sizes[b]);
+            ((char*)ptrs[b])[0] = (char)step;
+        }
+        for (int b = 0; b < nbuf; ++b) {
+            cache.deallocate(ptrs[b]);
+        }
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    const double nops = 2.0 * nsteps * nbuf;
+    const double tDirect = std::chrono::duration<double>(t1 - t0).count();
+    const double tCached = std::chrono::duration<double>(t2 - t1).count();
+    printf("Host benchmark (%s): %d steps x %d buffers: direct %.1f ns/op, cached %.1f ns/op (%.1fx)\n",
+           Backend::name(), nsteps, nbuf, 1e9 * tDirect / nops, 1e9 * tCached / nops, tDirect / tCached);
+    cache.printStats("after run");
+    cache.trim();
+    cache.printStats("after trim");
+}
+
+// Functional checks of the host backend: reuse, stream separation, splitting and coalescing
+void validateHost()
+{
+    CachingAllocator<HostBackend> cache;
+    void* a = cache.allocate(100, 0);
+    cache.deallocate(a);
+    void* b = cache.allocate(200, 0); // Same 256 B class, same stream: reused
+    void* c = cache.allocate(200, 1); // Other stream: fresh block
+    printf("Reuse on same stream: %s, separate on other stream: %s\n",
+           a == b ? "yes" : "NO", c != b ? "yes" : "NO");
+    cache.deallocate(b);
+    cache.deallocate(c);
+
+    void* l1 = cache.allocate(3u << 20, 0); // Splits a 4 MiB segment
+    void* l2 = cache.allocate(1u << 21, 0); // Needs a new segment
+    cache.deallocate(l1);                   // Merges with the free tail
+    void* l3 = cache.allocate(4u << 20, 0); // Fits the coalesced segment
+    printf("Coalesced segment reused: %s\n", l3 == l1 ? "yes" : "NO");
+    cache.deallocate(l2);
+    cache.deallocate(l3);
+    cache.printStats("validation");
+    cache.trim();
+    printf("Reserved after trim: %ld B\n", cache.stats().reserved);
+}
+
+#ifndef NOACC
+// Kernel to alter the attribute (from struct_with_dynamic_array)
+__global__ void alter_attribute(Basic* struc)
+{
+    int i = blockIdx.x;
+    int j = threadIdx.x;
+    if (i < 1)
+    {
+        struc[i].id = 3;
+        if (j < SIZE)
+        {
+            struc[i].value[j] = 3.0f + (float) j;
+        }
+    }
+}
+
+// struct_with_dynamic_array repeated in a time loop, with raw cudaMalloc or the caching allocator
+template <bool CACHED>
+double deviceTimeLoop(int nsteps, CachingAllocator<CudaBackend>& cache, Basic& h_struc, cudaStream_t stream)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (int step = 0; step < nsteps; ++step) {
+        Basic* d_struc;
+        float* tmp;
+        if (CACHED) {
+            d_struc = (Basic*)cache.allocate(sizeof(Basic), stream);
+            tmp = (float*)cache.allocate(SIZE * sizeof(float), stream);
+        } else {
+            cudaMalloc(&d_struc, sizeof(Basic));
+            cudaMalloc(&tmp, SIZE * sizeof(float));
+        }
+        cudaMemcpyAsync(&(d_struc->value), &tmp, sizeof(float*), cudaMemcpyHostToDevice, stream);
+        cudaMemcpyAsync(tmp, h_struc.value, SIZE * sizeof(float), cudaMemcpyHostToDevice, stream);
+        alter_attribute<<<1, SIZE, 0, stream>>>(d_struc);
+        cudaMemcpyAsync(h_struc.value, tmp, SIZE * sizeof(float), cudaMemcpyDeviceToHost, stream);
+        cudaStreamSynchronize(stream);
+        if (CACHED) {
+            cache.deallocate(tmp);
+            cache.deallocate(d_struc);
+        } else {
+            cudaFree(tmp);
+            cudaFree(d_struc);
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+#endif
+
+int main(int argc, const char** argv)
+{
+    const int nsteps = (argc > 1) ? atoi(argv[1]) : 1000;
+
+    // Host validation and microbenchmarks (no GPU required)
+    validateHost();
+    benchmarkHost<HostBackend>(nsteps, 64);
+    benchmarkHost<MmapBackend>(nsteps, 64);
+
+#ifndef NOACC
+    // Host:
+    // Create a single instance of Basic and initialize the atttributes
+    Basic h_struc;
+    h_struc.id = 2;
+    h_struc.value = (float*) malloc(SIZE * sizeof(float));
+    for (int i = 0; i < SIZE; i++)
+    {
+        h_struc.value[i] = 2.0f + (float) i;
+    }
+
+    // Device:
+    // Same struct built every step, with and without the cache
+    cudaStream_t stream;
+    cudaStreamCreate(&stream);
+    CachingAllocator<CudaBackend> cache;
+    double tRaw = deviceTimeLoop<false>(nsteps, cache, h_struc, stream);
+    double tCached = deviceTimeLoop<true>(nsteps, cache, h_struc, stream);
+    printf("Device time loop: %d steps, cudaMalloc/cudaFree %.2f us/step, cached %.2f us/step\n",
+           nsteps, 1e6 * tRaw / nsteps, 1e6 * tCached / nsteps);
+    cache.printStats("device");
+
+    // Print the info
+    for (int i = 0; i < SIZE; i++)
+    {
+        printf("Host: Basic.value[%d] = %f\n", i, h_struc.value[i]);
+    }
+
+    cache.trim();
+    cudaStreamDestroy(stream);
+    free(h_struc.value);
+#endif
+
+    return 0;
+}
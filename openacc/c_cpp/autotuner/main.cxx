@@ -0,0 +1,410 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Host auto-tuner for loop decompositions with an on-disk tuning cache
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Point class containing an id and a dynamic float array (innerObject)
+class Point
+{
+    private:
+        int pID;      // Unique identifier for the Point
+        int dataSize; // Size of the data array in elements
+        float* pData; // Data pointer as a dynamic array of floats
+    public:
+        int getId() const { return pID; }
+        int getDataSize() const { return dataSize; }
+        float* getData() const { return pData; }
+        void setPoint(int id, int n) {
+            this->pID = id;
+            this->dataSize = n;
+            this->pData = (float*)calloc(n, sizeof(float));
+        }
+};
+
+// Line class contains an array of Point objects (outerObject)
+class Line
+{
+    private:
+        int lID;       // Unique identifier for the Line
+        int nPoints;   // Number of Point objects in this Line
+        Point* points; // Pointer to an array of Point objects
+    public:
+        int getId() const { return lID; }
+        int getNPoints() const { return nPoints; }
+        Point* getPoints() const { return points; }
+        void setLine(int id, int np, int ndata) {
+            this->lID = id;
+            this->nPoints = np;
+            this->points = (Point*)calloc(np, sizeof(Point));
+            for (int i = 0; i < np; ++i) {
+                points[i].setPoint(lID * np + i, ndata);
+            }
+        }
+};
+
+// Problem shape a tuning result is valid for
+struct Shape
+{
+    int nlines; // Number of lines
+    int np;     // Points per line
+    int ndata;  // Data entries per point
+};
+
+// Loop level distributed among threads
+enum Level { LEVEL_LINES = 0, LEVEL_POINTS = 1, LEVEL_FLAT = 2 };
+const char* levelNames[] = { "lines", "points", "flat" };
+
+// One candidate decomposition
+struct Config
+{
+    int nthreads; // Host threads
+    int chunk;    // Work items grabbed per scheduling step
+    int tile;     // Points processed per tile (both updates applied per tile)
+    int level;    // Loop level that is parallelized (Level)
+    double time;  // Best measured time [s], negative if never measured
+};
+
+// Sanity check of a config read back from disk (a stale or edited cache must not be trusted)
+static bool isValid(const Config& c)
+{
+    return c.nthreads >= 1 && c.chunk >= 1 && c.tile >= 1 && c.level >= LEVEL_LINES && c.level <= LEVEL_FLAT;
+}
+
+// Key identifying the machine: host name, CPU model and hardware threads
+static std::string machineKey()
+{
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+    std::string model = "unknown_cpu";
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            model = line.substr(line.find(':') + 2);
+            break;
+        }
+    }
+    std::string key = std::string(host) + "|" + model + "|" + std::to_string(std::thread::hardware_concurrency());
+    // Keep the key a single whitespace-free token for the cache file
+    std::replace(key.begin(), key.end(), ' ', '_');
+    return key;
+}
+
+// Persistent tuning cache: one line per (kernel, shape, machine) with the chosen config
+class TuningCache
+{
+    private:
+        std::string path;                 // Cache file location
+        std::vector<std::string> keys;    // Entry keys
+        std::vector<Config> configs;      // Entry values
+    public:
+        explicit TuningCache(const std::string& file) : path(file) {
+            std::ifstream in(path);
+            std::string line;
+            while (std::getline(in, line)) {
+                std::istringstream ss(line);
+                std::string key;
+                Config c;
+                // Entries with impossible values are dropped (the shape bound on tile is checked at lookup)
+                if ((ss >> key >> c.nthreads >> c.chunk >> c.tile >> c.level >> c.time) && isValid(c)) {
+                    keys.push_back(key);
+                    configs.push_back(c);
+                }
+            }
+        }
+
+        static std::string makeKey(const std::string& kernel, const Shape& s, const std::string& machine) {
+            return kernel + "|" + std::to_string(s.nlines) + "x" + std::to_string(s.np) + "x"
+                 + std::to_string(s.ndata) + "|" + machine;
+        }
+
+        bool lookup(const std::string& key, Config& c) const {
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (keys[i] == key) {
+                    c = configs[i];
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Insert or replace an entry and rewrite the file
+        void store(const std::string& key, const Config& c) {
+            bool found = false;
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (keys[i] == key) {
+                    configs[i] = c;
+                    found = true;
+                }
+            }
+            if (!found) {
+                keys.push_back(key);
+                configs.push_back(c);
+            }
+            std::ofstream out(path, std::ios::trunc);
+            for (size_t i = 0; i < keys.size(); ++i) {
+                out << keys[i] << " " << configs[i].nthreads << " " << configs[i].chunk << " "
+                    << configs[i].tile << " " << configs[i].level << " " << configs[i].time << "\n";
+            }
+        }
+};
+
+// Run body(i, j0, j1) over all (line, point-tile) pairs with the given decomposition.
+// Work items are handed out in chunks through a shared atomic counter.
+template <class Body>
+void runDecomposed(const Config& c, const Shape& s, Body body)
+{
+    const int ntiles = (s.np + c.tile - 1) / c.tile;
+    std::atomic<long> next(0);
+
+    auto worker = [&]() {
+        if (c.level == LEVEL_LINES) {
+            // Items are lines; each thread sweeps all tiles of its lines
+            for (long start = next.fetch_add(c.chunk); start < s.nlines; start = next.fetch_add(c.chunk)) {
+                const long end = std::min<long>(start + c.chunk, s.nlines);
+                for (long i = start; i < end; ++i) {
+                    for (int t = 0; t < ntiles; ++t) {
+                        body(i, t * c.tile, std::min(s.np, (t + 1) * c.tile));
+                    }
+                }
+            }
+        } else if (c.level == LEVEL_FLAT) {
+            // Items are (line, tile) pairs of the flattened iteration space
+            const long nitems = (long)s.nlines * ntiles;
+            for (long start = next.fetch_add(c.chunk); start < nitems; start = next.fetch_add(c.chunk)) {
+                const long end = std::min<long>(start + c.chunk, nitems);
+                for (long it = start; it < end; ++it) {
+                    const int i = it / ntiles;
+                    const int t = it % ntiles;
+                    body(i, t * c.tile, std::min(s.np, (t + 1) * c.tile));
+                }
+            }
+        }
+    };
+
+    if (c.level == LEVEL_POINTS) {
+        // Lines stay sequential, the tiles of each line are shared (one fork/join per line)
+        for (int i = 0; i < s.nlines; ++i) {
+            std::atomic<int> tnext(0);
+            auto lineWorker = [&]() {
+                for (int start = tnext.fetch_add(c.chunk); start < ntiles; start = tnext.fetch_add(c.chunk)) {
+                    const int end = std::min(start + c.chunk, ntiles);
+                    for (int t = start; t < end; ++t) {
+                        body(i, t * c.tile, std::min(s.np, (t + 1) * c.tile));
+                    }
+                }
+            };
+            std::vector<std::thread> team;
+            for (int th = 1; th < c.nthreads; ++th) {
+                team.emplace_back(lineWorker);
+            }
+            lineWorker();
+            for (auto& th : team) {
+                th.join();
+            }
+        }
+        return;
+    }
+
+    std::vector<std::thread> team;
+    for (int th = 1; th < c.nthreads; ++th) {
+        team.emplace_back(worker);
+    }
+    worker();
+    for (auto& th : team) {
+        th.join();
+    }
+}
+
+// Times candidate decompositions and remembers the fastest through a TuningCache
+class AutoTuner
+{
+    private:
+        TuningCache cache;   // On-disk results
+        std::string machine; // Machine part of the cache key
+        int nrep;            // Timed repetitions per candidate (best one is kept)
+    public:
+        AutoTuner(const std::string& cacheFile, int reps) : cache(cacheFile), machine(machineKey()), nrep(reps) {}
+
+        // Candidate space for a shape: threads, chunk, tile and parallel level
+        std::vector<Config> candidates(const Shape& s) const {
+            std::vector<int> threads;
+            const int hw = std::max(1u, std::thread::hardware_concurrency());
+            for (int t = 1; t < hw; t *= 2) {
+                threads.push_back(t);
+            }
+            threads.push_back(hw);
+            // Tiles no longer than a line, without repeats (np may be one of the fixed sizes)
+            std::vector<int> tiles;
+            for (int tile : {8, 32, 128, s.np}) {
+                if (tile <= s.np && std::find(tiles.begin(), tiles.end(), tile) == tiles.end()) {
+                    tiles.push_back(tile);
+                }
+            }
+            std::vector<Config> list;
+            for (int t : threads) {
+                for (int chunk : {1, 4, 16, 64}) {
+                    for (int tile : tiles) {
+                        for (int level = LEVEL_LINES; level <= LEVEL_FLAT; ++level) {
+                            list.push_back(Config{t, chunk, tile, level, -1.0});
+                        }
+                    }
+                }
+            }
+            return list;
+        }
+
+        // Return the tuned config for (kernel, shape), timing all candidates on a cache miss
+        template <class Body>
+        Config tune(const std::string& kernel, const Shape& s, Body body, bool& fromCache) {
+            const std::string key = TuningCache::makeKey(kernel, s, machine);
+            Config best;
+            // An entry whose tile does not fit the shape is re-tuned (store() replaces it)
+            fromCache = cache.lookup(key, best) && best.tile <= s.np;
+            if (fromCache) {
+                return best;
+            }
+            PUSH_RANGE("AutoTuner::tune", 0);
+            best.time = -1.0;
+            for (Config c : candidates(s)) {
+                runDecomposed(c, s, body); // Warm-up
+                for (int r = 0; r < nrep; ++r) {
+                    auto t0 = std::chrono::steady_clock::now();
+                    runDecomposed(c, s, body);
+                    double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                    if (c.time < 0.0 || dt < c.time) {
+                        c.time = dt;
+                    }
+                }
+                if (best.time < 0.0 || c.time < best.time) {
+                    best = c;
+                }
+            }
+            POP_RANGE
+            cache.store(key, best);
+            return best;
+        }
+};
+
+// Cache file used when AUTOTUNE_CACHE is not set (CMake points it to the build directory)
+#ifndef AUTOTUNE_CACHE_DEFAULT
+#define AUTOTUNE_CACHE_DEFAULT "autotune_cache.txt"
+#endif
+
+int main(int argc, const char** argv)
+{
+    // Problem parameters
+    Shape s;
+    s.nlines = (argc > 1) ? atoi(argv[1]) : 1024; // Number of lines
+    s.np = (argc > 2) ? atoi(argv[2]) : 256;      // Points per line
+    s.ndata = (argc > 3) ? atoi(argv[3]) : 4;     // Data entries per point
+    const char* cacheFile = getenv("AUTOTUNE_CACHE") ? getenv("AUTOTUNE_CACHE") : AUTOTUNE_CACHE_DEFAULT;
+
+    PUSH_RANGE("main::initialize_lines", 0);
+    Line* lines = (Line*)calloc(s.nlines, sizeof(Line));
+    for (int i = 0; i < s.nlines; ++i) {
+        lines[i].setLine(i, s.np, s.ndata);
+    }
+    POP_RANGE
+
+    // kernel_1 + kernel_2 of array_of_objects applied tile by tile
+    const int ndata = s.ndata;
+    auto body = [=](int i, int j0, int j1) {
+        Point* points = lines[i].getPoints();
+        for (int j = j0; j < j1; ++j) {
+            float* data = points[j].getData();
+            for (int k = 0; k < ndata; ++k) {
+                data[k] += static_cast<float>(1);
+            }
+        }
+        for (int j = j0; j < j1; ++j) {
+            float* data = points[j].getData();
+            for (int k = 0; k < ndata; ++k) {
+                data[k] += static_cast<float>(i+j+k);
+            }
+        }
+    };
+
+    AutoTuner tuner(cacheFile, 3);
+    bool fromCache = false;
+    auto t0 = std::chrono::steady_clock::now();
+    Config best = tuner.tune("array_of_objects::kernel_1_2", s, body, fromCache);
+    double tuneTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    printf("Shape: nlines=%d np=%d ndata=%d\n", s.nlines, s.np, s.ndata);
+    printf("%s in %.3f s (cache: %s)\n", fromCache ? "Loaded tuned config" : "Tuned", tuneTime, cacheFile);
+    printf("Best: threads=%d chunk=%d tile=%d level=%s, %.3f ms\n",
+           best.nthreads, best.chunk, best.tile, levelNames[best.level], 1e3 * best.time);
+
+    // Compare against the fixed schedule of the original example (lines split, whole line per item)
+    Config fixed = {(int)std::max(1u, std::thread::hardware_concurrency()), 1, s.np, LEVEL_LINES, -1.0};
+    double tFixed = 0.0, tTuned = 0.0;
+    for (int r = 0; r < 5; ++r) {
+        auto a = std::chrono::steady_clock::now();
+        runDecomposed(fixed, s, body);
+        auto b = std::chrono::steady_clock::now();
+        runDecomposed(best, s, body);
+        auto c = std::chrono::steady_clock::now();
+        tFixed += std::chrono::duration<double>(b - a).count();
+        tTuned += std::chrono::duration<double>(c - b).count();
+    }
+    printf("Fixed schedule: %.3f ms, tuned schedule: %.3f ms\n", 1e3 * tFixed / 5, 1e3 * tTuned / 5);
+
+    return 0;
+}
@@ -0,0 +1,385 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Parallel bulk construction of Line/Point objects with thread-local arenas and batched device registration
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Point class containing an id and a dynamic float array (from array_of_objects)
+class Point
+{
+    private:
+        int pID;      // Unique identifier for the Point
+        int dataSize; // Size of the data array in elements
+        float* pData; // Data pointer as a dynamic array of floats
+    public:
+        int getId() const { return pID; }
+        int getDataSize() const { return dataSize; }
+        float* getData() const { return pData; }
+        float*& dataPointer() { return pData; }
+        // Individual construction, as in array_of_objects
+        void setPoint(int id, int n) {
+            pID = id;
+            dataSize = n;
+            pData = (float*)calloc(n, sizeof(float));
+            initData();
+            #pragma acc enter data copyin(pData[0:dataSize])
+        }
+        // Bulk construction: storage provided by the caller, no device registration
+        void setPoint(int id, int n, float* storage) {
+            pID = id;
+            dataSize = n;
+            pData = storage;
+            initData();
+        }
+        void initData() {
+            for (int k = 0; k < dataSize; ++k) {
+                pData[k] = (float)(pID % 1000) + 0.1f * k;
+            }
+        }
+};
+
+// Line class contains an array of Point objects
+class Line
+{
+    private:
+        int lID;       // Unique identifier for the Line
+        int nPoints;   // Number of Point objects in this Line
+        Point* points; // Pointer to an array of Point objects
+    public:
+        int getNPoints() const { return nPoints; }
+        Point* getPoints() const { return points; }
+        Point*& pointsPointer() { return points; }
+        // Individual construction, as in array_of_objects
+        void setLine(int id, int firstPoint, int np, int ndata) {
+            lID = id;
+            nPoints = np;
+            points = (Point*)calloc(np, sizeof(Point));
+            #pragma acc enter data copyin(points[0:nPoints])
+            for (int i = 0; i < np; ++i) {
+                points[i].setPoint(firstPoint + i, ndata);
+            }
+        }
+        // Bulk construction: Point array provided by the caller
+        void setLine(int id, int np, Point* storage) {
+            lID = id;
+            nPoints = np;
+            points = storage;
+        }
+};
+
+/**
+ * @brief Bump allocator owned by one thread
+ *
+ * The owning thread allocates the block and is the first to write every page of it, so on a
+ * NUMA node the pages land next to the core that built (and will later use) the objects.
+ */
+class Arena
+{
+    private:
+        char* base;
+        size_t size;
+        size_t used;
+    public:
+        Arena() : base(nullptr), size(0), used(0) {}
+        void reserve(size_t bytes) {
+            size = bytes;
+            used = 0;
+            base = (char*)malloc(bytes); // Not touched here: first touch happens during construction
+        }
+        void* alloc(size_t bytes, size_t align) {
+            used = (used + align - 1) / align * align;
+            void* p = base + used;
+            used += bytes;
+            return p;
+        }
+        char* getBase() const { return base; }
+        size_t getSize() const { return size; }
+        size_t getUsed() const { return used; }
+        void release() {
+            free(base);
+            base = nullptr;
+        }
+};
+
+/**
+ * @brief All Lines and Points of a mesh, built in parallel from a size array
+ *
+ * Threads own contiguous line ranges holding about the same number of points. Each thread
+ * places the Point arrays and payloads of its lines in its own arena and builds them there.
+ * Device registration is batched: the Line array and each arena are copied in with one
+ * directive each, and a relocation kernel per arena rewrites the embedded host pointers into
+ * device pointers, instead of one enter data per Line and per Point.
+ */
+class LineSet
+{
+    private:
+        int nlines;
+        long npoints;
+        int nthreads;
+        Line* lines;
+        std::vector<int> lineBegin; // Line range of each thread
+        std::vector<Arena> arenas;
+        long registrations;
+    public:
+        LineSet() : nlines(0), npoints(0), nthreads(0), lines(nullptr), registrations(0) {}
+
+        void build(const int* pointsPerLine, int n, int ndata, int nt) {
+            nlines = n;
+            nthreads = nt;
+            std::vector<long> firstPoint(nlines + 1, 0);
+            for (int l = 0; l < nlines; ++l) {
+                firstPoint[l + 1] = firstPoint[l] + pointsPerLine[l];
+            }
+            npoints = firstPoint[nlines];
+
+            // Balanced partition by point count
+            lineBegin.assign(nthreads + 1, nlines);
+            lineBegin[0] = 0;
+            for (int t = 1; t < nthreads; ++t) {
+                lineBegin[t] = (int)(std::lower_bound(firstPoint.begin(), firstPoint.end(), npoints * t / nthreads) - firstPoint.begin());
+            }
+
+            lines = (Line*)malloc(nlines * sizeof(Line));
+            arenas.assign(nthreads, Arena());
+
+            auto worker = [&](int t) {
+                const int l0 = lineBegin[t], l1 = lineBegin[t + 1];
+                const long np = firstPoint[l1] - firstPoint[l0];
+                arenas[t].reserve(np * sizeof(Point) + np * ndata * sizeof(float) + (l1 - l0) * alignof(Point));
+                for (int l = l0; l < l1; ++l) {
+                    Point* pts = (Point*)arenas[t].alloc(pointsPerLine[l] * sizeof(Point), alignof(Point));
+                    float* data = (float*)arenas[t].alloc((size_t)pointsPerLine[l] * ndata * sizeof(float), alignof(float));
+                    lines[l].setLine(l, pointsPerLine[l], pts);
+                    for (int i = 0; i < pointsPerLine[l]; ++i) {
+                        pts[i].setPoint((int)(firstPoint[l] + i), ndata, data + (size_t)i * ndata);
+                    }
+                }
+            };
+            std::vector<std::thread> team;
+            for (int t = 1; t < nthreads; ++t) {
+                team.emplace_back(worker, t);
+            }
+            worker(0);
+            for (auto& th : team) {
+                th.join();
+            }
+        }
+
+        // One copyin for the Line array and one per arena, then pointer relocation on the device
+        void toDevice() {
+            PUSH_RANGE("LineSet::toDevice", 1);
+            #pragma acc enter data copyin(lines[0:nlines])
+            registrations = 1;
+            for (int t = 0; t < nthreads; ++t) {
+                [[maybe_unused]] char* base = arenas[t].getBase();
+                [[maybe_unused]] const size_t used = arenas[t].getUsed();
+                #pragma acc enter data copyin(base[0:used])
+                registrations++;
+#ifndef NOACC
+                const intptr_t shift = (intptr_t)acc_deviceptr(base) - (intptr_t)base;
+                const int l0 = lineBegin[t], l1 = lineBegin[t + 1];
+                Line* ls = lines;
+                #pragma acc parallel loop gang present(ls[0:nlines])
+                for (int l = l0; l < l1; ++l) {
+                    Point* pts = (Point*)((intptr_t)ls[l].getPoints() + shift); // Device address of the Point array
+                    ls[l].pointsPointer() = pts;
+                    #pragma acc loop vector
+                    for (int i = 0; i < ls[l].getNPoints(); ++i) {
+                        pts[i].dataPointer() = (float*)((intptr_t)pts[i].getData() + shift);
+                    }
+                }
+#endif
+            }
+            POP_RANGE
+        }
+
+        long getNPoints() const { return npoints; }
+        long getRegistrations() const { return registrations; }
+        Line* getLines() const { return lines; }
+        size_t bytes() const {
+            size_t b = nlines * sizeof(Line);
+            for (const Arena& a : arenas) {
+                b += a.getUsed();
+            }
+            return b;
+        }
+
+        void release() {
+            #pragma acc exit data delete(lines[0:nlines])
+            for (Arena& a : arenas) {
+                [[maybe_unused]] char* base = a.getBase();
+                #pragma acc exit data delete(base[0:a.getUsed()])
+                a.release();
+            }
+            free(lines);
+        }
+};
+
+// Sum of ids and payloads, to compare both construction paths
+double checksum(const Line* lines, int nlines)
+{
+    double s = 0.0;
+    for (int l = 0; l < nlines; ++l) {
+        const Point* pts = lines[l].getPoints();
+        for (int i = 0; i < lines[l].getNPoints(); ++i) {
+            s += pts[i].getId();
+            for (int k = 0; k < pts[i].getDataSize(); ++k) {
+                s += pts[i].getData()[k];
+            }
+        }
+    }
+    return s;
+}
+
+// Same sum on the device, through the relocated pointers: verifies the relocation in toDevice
+double deviceChecksum(const Line* lines, int nlines)
+{
+    double s = 0.0;
+    #pragma acc parallel loop gang present(lines[0:nlines]) reduction(+:s)
+    for (int l = 0; l < nlines; ++l) {
+        const Point* pts = lines[l].getPoints();
+        #pragma acc loop vector reduction(+:s)
+        for (int i = 0; i < lines[l].getNPoints(); ++i) {
+            s += pts[i].getId();
+            #pragma acc loop seq
+            for (int k = 0; k < pts[i].getDataSize(); ++k) {
+                s += pts[i].getData()[k];
+            }
+        }
+    }
+    return s;
+}
+
+double seconds(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, const char** argv)
+{
+    const long target = (argc > 1) ? atol(argv[1]) : 10000000; // Number of points
+    const int ndata = (argc > 2) ? atoi(argv[2]) : 5;         // Payload entries per point
+    const int nthreads = (argc > 3) ? atoi(argv[3]) : (int)std::max(1u, std::thread::hardware_concurrency());
+    const bool skipSerial = (argc > 4) && atoi(argv[4]) != 0;
+
+    // Mixed line sizes between 8 and 64 points
+    std::vector<int> sizes;
+    long total = 0;
+    while (total < target) {
+        const int np = (int)std::min<long>(8 + (sizes.size() * 37) % 57, target - total);
+        sizes.push_back(np);
+        total += np;
+    }
+    const int nlines = (int)sizes.size();
+    printf("%d lines, %ld points, %d floats per point, %d threads\n", nlines, total, ndata, nthreads);
+
+    LineSet set;
+    double tBulk = 0.0, tDevice = 0.0;
+    {
+        PUSH_RANGE("main::bulk_build", 0);
+        auto t0 = std::chrono::steady_clock::now();
+        set.build(sizes.data(), nlines, ndata, nthreads);
+        tBulk = seconds(t0);
+        POP_RANGE
+        t0 = std::chrono::steady_clock::now();
+        set.toDevice();
+        tDevice = seconds(t0);
+    }
+    const size_t bytes = set.bytes();
+    // Reference bandwidth: the same threads write the same number of bytes into fresh pages
+    double tMemset = 0.0;
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        char* ref = (char*)malloc(bytes);
+        std::vector<std::thread> team;
+        for (int t = 1; t < nthreads; ++t) {
+            team.emplace_back([=] { memset(ref + bytes * t / nthreads, 1, bytes * (t + 1) / nthreads - bytes * t / nthreads); });
+        }
+        memset(ref, 1, bytes / nthreads);
+        for (auto& th : team) {
+            th.join();
+        }
+        tMemset = seconds(t0);
+        volatile char keep = ref[bytes / 2]; // Keeps the compiler from dropping the memset
+        (void)keep;
+        printf("reference first-touch memset: %.1f MB in %.3f s (%.2f GB/s)\n", 1e-6 * bytes, tMemset, 1e-9 * bytes / tMemset);
+        free(ref);
+    }
+    printf("bulk      : build %.3f s (%.2f GB/s, %.0f%% of memset), device registration %.3f s, %ld registrations\n",
+           tBulk, 1e-9 * bytes / tBulk, 100.0 * tMemset / tBulk, tDevice, set.getRegistrations());
+    const double sumBulk = checksum(set.getLines(), nlines);
+    const double sumDevice = deviceChecksum(set.getLines(), nlines);
+    printf("bulk      : device checksum %s\n",
+           (std::fabs(sumDevice - sumBulk) <= 1e-9 * std::fabs(sumBulk)) ? "matches" : "DIFFERS"); // Summation order differs
+
+    if (!skipSerial) {
+        PUSH_RANGE("main::serial_build", 2);
+        auto t0 = std::chrono::steady_clock::now();
+        Line* lines = (Line*)calloc(nlines, sizeof(Line));
+        #pragma acc enter data copyin(lines[0:nlines])
+        long first = 0;
+        for (int l = 0; l < nlines; ++l) {
+            lines[l].setLine(l, (int)first, sizes[l], ndata);
+            first += sizes[l];
+        }
+        const double tSerial = seconds(t0);
+        POP_RANGE
+        printf("serial    : build + registration %.3f s, %ld registrations, checksum %s\n",
+               tSerial, 1 + nlines + total, (checksum(lines, nlines) == sumBulk) ? "matches" : "DIFFERS");
+        printf("speedup   : %.2fx\n", tSerial / (tBulk + tDevice));
+        // The serial objects are not released, as in array_of_objects
+    }
+
+    set.release();
+    return 0;
+}
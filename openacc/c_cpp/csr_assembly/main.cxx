@@ -0,0 +1,419 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief CSR and SELL-C-sigma sparse operators assembled from Line connectivity, with threaded SpMV
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Run f(t, begin, end) on nthreads host threads over static blocks of [0, n)
+template <class F>
+void parallelBlocks(int nthreads, long n, F f)
+{
+    std::vector<std::thread> team;
+    for (int t = 1; t < nthreads; ++t) {
+        team.emplace_back(f, t, n * t / nthreads, n * (t + 1) / nthreads);
+    }
+    f(0, 0L, n / nthreads);
+    for (auto& th : team) {
+        th.join();
+    }
+}
+
+// Exclusive prefix sum in place over counts[0:n], counts[n] receives the total
+void exclusiveScan(long* counts, long n)
+{
+    long s = 0;
+    for (long i = 0; i < n; ++i) {
+        const long c = counts[i];
+        counts[i] = s;
+        s += c;
+    }
+    counts[n] = s;
+}
+
+// Point class: only the global ID matters for the connectivity
+class Point
+{
+    private:
+        int pID; // Global point ID
+    public:
+        int getId() const { return pID; }
+        void setPoint(int id) { pID = id; }
+};
+
+// Line class contains an array of Point objects; couples all its points (one element)
+class Line
+{
+    private:
+        int lID;       // Unique identifier for the Line
+        int nPoints;   // Number of Point objects in this Line
+        Point* points; // Pointer to an array of Point objects
+    public:
+        int getNPoints() const { return nPoints; }
+        const Point* getPoints() const { return points; }
+        // pid = lID * np + i as in array_of_objects, or with the end points shared by consecutive lines
+        void setLine(int id, int np, bool shared) {
+            lID = id;
+            nPoints = np;
+            points = (Point*)calloc(np, sizeof(Point));
+            for (int i = 0; i < np; ++i) {
+                points[i].setPoint(shared ? lID * (np - 1) + i : lID * np + i);
+            }
+        }
+        // Element matrix entry coupling local points i and j (symmetric, diagonally dominant)
+        double elementEntry(int i, int j) const {
+            return (i == j) ? (double)nPoints : -1.0 / (1.0 + std::abs(i - j));
+        }
+};
+
+// Compressed sparse row matrix
+struct CsrMatrix
+{
+    int nrows = 0;
+    long nnz = 0;
+    std::vector<long> rowPtr;
+    std::vector<int> cols;
+    std::vector<double> vals;
+};
+
+/**
+ * @brief Two-pass parallel assembly of the CSR matrix implied by the Lines' point IDs
+ *
+ * A point-to-line map is built first, so that every row can be processed independently:
+ * 1. symbolic: each row merges the point IDs of its lines (sorted, unique) and counts them;
+ *    a prefix sum gives rowPtr, and a second sweep writes the columns;
+ * 2. numeric: each row adds the element matrix entries of its lines into its own columns,
+ *    found by binary search. Rows are owned by a single thread, so no atomics are needed.
+ */
+CsrMatrix assemble(const Line* lines, int nlines, int npoints, int nthreads)
+{
+    CsrMatrix A;
+    A.nrows = npoints;
+
+    // Point -> (line, local index) map, as CSR
+    std::vector<long> p2lPtr(npoints + 1, 0);
+    for (int l = 0; l < nlines; ++l) {
+        for (int i = 0; i < lines[l].getNPoints(); ++i) {
+            p2lPtr[lines[l].getPoints()[i].getId()]++;
+        }
+    }
+    exclusiveScan(p2lPtr.data(), npoints);
+    std::vector<int> p2lLine(p2lPtr[npoints]), p2lLocal(p2lPtr[npoints]);
+    {
+        std::vector<long> fill(p2lPtr.begin(), p2lPtr.end() - 1);
+        for (int l = 0; l < nlines; ++l) {
+            for (int i = 0; i < lines[l].getNPoints(); ++i) {
+                const long k = fill[lines[l].getPoints()[i].getId()]++;
+                p2lLine[k] = l;
+                p2lLocal[k] = i;
+            }
+        }
+    }
+
+    // Sorted unique columns of row r into buf
+    auto rowColumns = [&](int r, std::vector<int>& buf) {
+        buf.clear();
+        for (long k = p2lPtr[r]; k < p2lPtr[r + 1]; ++k) {
+            const Line& line = lines[p2lLine[k]];
+            for (int j = 0; j < line.getNPoints(); ++j) {
+                buf.push_back(line.getPoints()[j].getId());
+            }
+        }
+        std::sort(buf.begin(), buf.end());
+        buf.erase(std::unique(buf.begin(), buf.end()), buf.end());
+    };
+
+    // Symbolic pass 1: row lengths
+    PUSH_RANGE("assemble::symbolic_count", 0);
+    A.rowPtr.assign(npoints + 1, 0);
+    parallelBlocks(nthreads, npoints, [&](int, long begin, long end) {
+        std::vector<int> buf;
+        for (long r = begin; r < end; ++r) {
+            rowColumns((int)r, buf);
+            A.rowPtr[r] = (long)buf.size();
+        }
+    });
+    exclusiveScan(A.rowPtr.data(), npoints);
+    A.nnz = A.rowPtr[npoints];
+    POP_RANGE
+
+    // Symbolic pass 2: columns
+    PUSH_RANGE("assemble::symbolic_fill", 1);
+    A.cols.resize(A.nnz);
+    A.vals.assign(A.nnz, 0.0);
+    parallelBlocks(nthreads, npoints, [&](int, long begin, long end) {
+        std::vector<int> buf;
+        for (long r = begin; r < end; ++r) {
+            rowColumns((int)r, buf);
+            std::copy(buf.begin(), buf.end(), A.cols.begin() + A.rowPtr[r]);
+        }
+    });
+    POP_RANGE
+
+    // Numeric pass: row-owned accumulation of the element matrices
+    PUSH_RANGE("assemble::numeric", 2);
+    parallelBlocks(nthreads, npoints, [&](int, long begin, long end) {
+        for (long r = begin; r < end; ++r) {
+            const int* rc = A.cols.data() + A.rowPtr[r];
+            const int len = (int)(A.rowPtr[r + 1] - A.rowPtr[r]);
+            for (long k = p2lPtr[r]; k < p2lPtr[r + 1]; ++k) {
+                const Line& line = lines[p2lLine[k]];
+                const int i = p2lLocal[k];
+                for (int j = 0; j < line.getNPoints(); ++j) {
+                    const int c = line.getPoints()[j].getId();
+                    const long pos = std::lower_bound(rc, rc + len, c) - rc;
+                    A.vals[A.rowPtr[r] + pos] += line.elementEntry(i, j);
+                }
+            }
+        }
+    });
+    POP_RANGE
+
+    return A;
+}
+
+// Threaded CSR SpMV; rows are split so each thread gets about the same number of nonzeros
+void spmvCsr(const CsrMatrix& A, const double* x, double* y, int nthreads)
+{
+    parallelBlocks(nthreads, A.nnz, [&](int, long nzBegin, long nzEnd) {
+        const long* rp = A.rowPtr.data();
+        const int rBegin = (int)(std::lower_bound(rp, rp + A.nrows, nzBegin) - rp);
+        const int rEnd = (int)(std::lower_bound(rp, rp + A.nrows, nzEnd) - rp);
+        const int* c = A.cols.data();
+        const double* v = A.vals.data();
+        for (int r = rBegin; r < rEnd; ++r) {
+            double s = 0.0;
+            for (long k = rp[r]; k < rp[r + 1]; ++k) {
+                s += v[k] * x[c[k]];
+            }
+            y[r] = s;
+        }
+    });
+}
+
+/**
+ * @brief SELL-C-sigma layout: rows sorted by length inside windows of sigma rows, grouped in
+ * chunks of C rows padded to the longest row of the chunk, stored column-major inside a chunk
+ *
+ * The SpMV inner loop runs over the C rows of a chunk with unit stride, which vectorizes, and
+ * sorting keeps the padding small when row lengths vary.
+ */
+struct SellMatrix
+{
+    int C = 8;
+    int sigma = 256;
+    int nrows = 0;
+    int nchunks = 0;
+    long stored = 0;               // Stored entries, padding included
+    std::vector<int> perm;         // Original row of sorted row i
+    std::vector<int> chunkLen;     // Width of each chunk
+    std::vector<long> chunkPtr;    // Start of each chunk
+    std::vector<int> cols;
+    std::vector<double> vals;
+
+    void build(const CsrMatrix& A, int c, int s) {
+        C = c;
+        sigma = std::max(s, c);
+        nrows = A.nrows;
+        nchunks = (nrows + C - 1) / C;
+        perm.resize((size_t)nchunks * C);
+        for (int i = 0; i < (int)perm.size(); ++i) {
+            perm[i] = std::min(i, nrows - 1);
+        }
+        auto len = [&](int r) { return A.rowPtr[r + 1] - A.rowPtr[r]; };
+        for (int w = 0; w < nrows; w += sigma) {
+            std::stable_sort(perm.begin() + w, perm.begin() + std::min(w + sigma, nrows),
+                             [&](int a, int b) { return len(a) > len(b); });
+        }
+        chunkLen.resize(nchunks);
+        chunkPtr.resize(nchunks + 1);
+        chunkPtr[0] = 0;
+        for (int ch = 0; ch < nchunks; ++ch) {
+            long w = 0;
+            for (int i = 0; i < C && ch * C + i < nrows; ++i) {
+                w = std::max(w, len(perm[ch * C + i]));
+            }
+            chunkLen[ch] = (int)w;
+            chunkPtr[ch + 1] = chunkPtr[ch] + w * C;
+        }
+        stored = chunkPtr[nchunks];
+        // Padding points at column 0 with a zero value
+        cols.assign(stored, 0);
+        vals.assign(stored, 0.0);
+        for (int ch = 0; ch < nchunks; ++ch) {
+            for (int i = 0; i < C && ch * C + i < nrows; ++i) {
+                const int r = perm[ch * C + i];
+                for (long k = A.rowPtr[r]; k < A.rowPtr[r + 1]; ++k) {
+                    const long j = k - A.rowPtr[r];
+                    cols[chunkPtr[ch] + j * C + i] = A.cols[k];
+                    vals[chunkPtr[ch] + j * C + i] = A.vals[k];
+                }
+            }
+        }
+    }
+};
+
+// Threaded SELL-C-sigma SpMV; chunks are split so each thread gets about the same stored entries
+template <int C>
+void spmvSell(const SellMatrix& S, const double* x, double* y, int nthreads)
+{
+    parallelBlocks(nthreads, S.stored, [&](int, long begin, long end) {
+        const long* cp = S.chunkPtr.data();
+        const int chBegin = (int)(std::lower_bound(cp, cp + S.nchunks, begin) - cp);
+        const int chEnd = (int)(std::lower_bound(cp, cp + S.nchunks, end) - cp);
+        for (int ch = chBegin; ch < chEnd; ++ch) {
+            const int* c = S.cols.data() + cp[ch];
+            const double* v = S.vals.data() + cp[ch];
+            double s[C] = {};
+            for (int j = 0; j < S.chunkLen[ch]; ++j) {
+                for (int i = 0; i < C; ++i) {
+                    s[i] += v[j * C + i] * x[c[j * C + i]];
+                }
+            }
+            for (int i = 0; i < C && ch * C + i < S.nrows; ++i) {
+                y[S.perm[ch * C + i]] = s[i];
+            }
+        }
+    });
+}
+
+template <class F>
+double timeIt(int nrep, F f)
+{
+    f();
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < nrep; ++r) {
+        f();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() / nrep;
+}
+
+int main(int argc, const char** argv)
+{
+    int nlines = 200000; // Number of lines
+    int np = 16;         // Points per line
+    bool shared = false; // Share the end points of consecutive lines
+    int sigma = 256;     // SELL sorting window
+    int nrep = 20;       // Timed SpMVs
+    for (int a = 1; a < argc; ++a) {
+        if (strcmp(argv[a], "--shared") == 0) {
+            shared = true;
+        } else if (strcmp(argv[a], "--lines") == 0 && a + 1 < argc) {
+            nlines = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--np") == 0 && a + 1 < argc) {
+            np = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--sigma") == 0 && a + 1 < argc) {
+            sigma = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--nrep") == 0 && a + 1 < argc) {
+            nrep = atoi(argv[++a]);
+        }
+    }
+    const int nthreads = (int)std::max(1u, std::thread::hardware_concurrency());
+    const int npoints = shared ? nlines * (np - 1) + 1 : nlines * np;
+
+    Line* lines = (Line*)calloc(nlines, sizeof(Line));
+    for (int l = 0; l < nlines; ++l) {
+        lines[l].setLine(l, np, shared);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    CsrMatrix A = assemble(lines, nlines, npoints, nthreads);
+    const double tAssemble = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    printf("%d lines x %d points (%s end points), %d threads: %d rows, %ld nnz (%.1f per row), assembled in %.1f ms\n",
+           nlines, np, shared ? "shared" : "separate", nthreads, A.nrows, A.nnz, (double)A.nnz / A.nrows, 1e3 * tAssemble);
+
+    constexpr int C = 8;
+    SellMatrix S;
+    S.build(A, C, sigma);
+
+    std::vector<double> x(npoints), yCsr(npoints), ySell(npoints), yRef(npoints, 0.0);
+    for (int i = 0; i < npoints; ++i) {
+        x[i] = 1.0 + 0.001 * (i % 997);
+    }
+
+    // Reference: element-by-element product straight from the Lines
+    for (int l = 0; l < nlines; ++l) {
+        const Point* p = lines[l].getPoints();
+        for (int i = 0; i < np; ++i) {
+            for (int j = 0; j < np; ++j) {
+                yRef[p[i].getId()] += lines[l].elementEntry(i, j) * x[p[j].getId()];
+            }
+        }
+    }
+
+    PUSH_RANGE("spmv::csr", 3);
+    const double tCsr = timeIt(nrep, [&] { spmvCsr(A, x.data(), yCsr.data(), nthreads); });
+    POP_RANGE
+    PUSH_RANGE("spmv::sell", 4);
+    const double tSell = timeIt(nrep, [&] { spmvSell<C>(S, x.data(), ySell.data(), nthreads); });
+    POP_RANGE
+
+    double errCsr = 0.0, errSell = 0.0;
+    for (int i = 0; i < npoints; ++i) {
+        errCsr = std::max(errCsr, std::fabs(yCsr[i] - yRef[i]) / std::fabs(yRef[i]));
+        errSell = std::max(errSell, std::fabs(ySell[i] - yRef[i]) / std::fabs(yRef[i]));
+    }
+
+    // Matrix bytes per nonzero (values, column indices, row/chunk metadata), plus the compulsory x/y traffic
+    const double vecBytes = 2.0 * 8.0 * npoints;
+    const double csrBytes = 12.0 * A.nnz + 8.0 * (A.nrows + 1);
+    const double sellBytes = 12.0 * S.stored + 12.0 * S.nchunks + 4.0 * S.perm.size();
+    printf("%-14s | %8s | %10s | %10s | %9s | %s\n", "layout", "GFLOP/s", "bytes/nnz", "GB/s", "fill", "max rel. error");
+    printf("%-14s | %8.2f | %10.2f | %10.2f | %8.1f%% | %.1e\n", "CSR", 2e-9 * A.nnz / tCsr, csrBytes / A.nnz,
+           1e-9 * (csrBytes + vecBytes) / tCsr, 100.0, errCsr);
+    char name[32];
+    snprintf(name, sizeof(name), "SELL-%d-%d", C, S.sigma);
+    printf("%-14s | %8.2f | %10.2f | %10.2f | %8.1f%% | %.1e\n", name, 2e-9 * A.nnz / tSell, sellBytes / A.nnz,
+           1e-9 * (sellBytes + vecBytes) / tSell, 100.0 * A.nnz / S.stored, errSell);
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Ensemble batching of many small independent Basic problems into a single launch
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Problem size of one instance (as in struct_with_static_array and multiple_c_struct)
+#define SIZE 3
+#define NUM_OBJ 10
+
+struct Basic
+{
+    int id;
+    float value[SIZE];
+};
+
+// One small independent problem: NUM_OBJ Basic objects and its own parameters
+struct Instance
+{
+    Basic objs[NUM_OBJ];
+    float rate;  // Relaxation rate
+    int niter;   // Relaxation sweeps
+};
+
+// Relaxation of every value towards id + j (host/device callable)
+inline void relax(Basic& b, int j, float rate, int niter)
+{
+    float v = b.value[j];
+    const float target = (float)b.id + (float)j;
+    for (int it = 0; it < niter; ++it) {
+        v += rate * (target - v);
+    }
+    b.value[j] = v;
+}
+
+// One instance at a time: its own copyin, launch and copyout
+void solveOne(Instance& inst)
+{
+    Basic* objs = inst.objs;
+    const float rate = inst.rate;
+    const int niter = inst.niter;
+    #pragma acc parallel loop collapse(2) copy(objs[0:NUM_OBJ])
+    for (int o = 0; o < NUM_OBJ; ++o) {
+        for (int j = 0; j < SIZE; ++j) {
+            relax(objs[o], j, rate, niter);
+        }
+    }
+}
+
+/**
+ * @brief K instances stacked into one batched structure
+ *
+ * Objects of instance k occupy objs[k * NUM_OBJ : (k + 1) * NUM_OBJ] and its parameters are
+ * rate[k] and niter[k]. The instance index is the outer (gang) dimension, so the whole
+ * ensemble needs one transfer each way and one launch.
+ */
+class Ensemble
+{
+    private:
+        int K;
+        Basic* objs;
+        float* rate;
+        int* niter;
+    public:
+        explicit Ensemble(int k) : K(k) {
+            objs = (Basic*)malloc((size_t)K * NUM_OBJ * sizeof(Basic));
+            rate = (float*)malloc(K * sizeof(float));
+            niter = (int*)malloc(K * sizeof(int));
+            #pragma acc enter data create(objs[0:K*NUM_OBJ], rate[0:K], niter[0:K])
+        }
+        ~Ensemble() {
+            #pragma acc exit data delete(objs[0:K*NUM_OBJ], rate[0:K], niter[0:K])
+            free(objs);
+            free(rate);
+            free(niter);
+        }
+
+        // Stack the instances (host) and send them in one transfer per array
+        void gather(const Instance* inst) {
+            for (int k = 0; k < K; ++k) {
+                memcpy(&objs[(size_t)k * NUM_OBJ], inst[k].objs, NUM_OBJ * sizeof(Basic));
+                rate[k] = inst[k].rate;
+                niter[k] = inst[k].niter;
+            }
+            #pragma acc update device(objs[0:K*NUM_OBJ], rate[0:K], niter[0:K])
+        }
+
+        // All instances in one launch: gang over instances, vector over their objects and values
+        void solve() {
+            const int nk = K;
+            Basic* o = objs;
+            const float* r = rate;
+            const int* n = niter;
+            #pragma acc parallel loop gang present(o[0:nk*NUM_OBJ], r[0:nk], n[0:nk])
+            for (int k = 0; k < nk; ++k) {
+                #pragma acc loop vector collapse(2)
+                for (int b = 0; b < NUM_OBJ; ++b) {
+                    for (int j = 0; j < SIZE; ++j) {
+                        relax(o[(size_t)k * NUM_OBJ + b], j, r[k], n[k]);
+                    }
+                }
+            }
+        }
+
+        // One transfer back, then the results are scattered to their instances
+        void scatter(Instance* inst) {
+            #pragma acc update self(objs[0:K*NUM_OBJ])
+            for (int k = 0; k < K; ++k) {
+                memcpy(inst[k].objs, &objs[(size_t)k * NUM_OBJ], NUM_OBJ * sizeof(Basic));
+            }
+        }
+};
+
+// Instance k: parameter sweep over the relaxation rate and sweep count
+void initInstances(std::vector<Instance>& inst)
+{
+    for (size_t k = 0; k < inst.size(); ++k) {
+        for (int o = 0; o < NUM_OBJ; ++o) {
+            inst[k].objs[o].id = o + 1;
+            for (int j = 0; j < SIZE; ++j) {
+                inst[k].objs[o].value[j] = 1.0f + (float)j;
+            }
+        }
+        inst[k].rate = 0.05f + 0.9f * (float)(k % 97) / 97.0f;
+        inst[k].niter = 5 + (int)(k % 11);
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    const int maxK = (argc > 1) ? atoi(argv[1]) : 100000; // Largest ensemble
+    const int ks[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+    printf("%9s | %16s | %16s | %8s | %s\n", "instances", "one-by-one [1/s]", "batched [1/s]", "speedup", "max diff");
+    for (int K : ks) {
+        if (K > maxK) {
+            break;
+        }
+        std::vector<Instance> single(K), batched(K);
+        initInstances(single);
+        initInstances(batched);
+
+        PUSH_RANGE("one_by_one", 0);
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < K; ++k) {
+            solveOne(single[k]);
+        }
+        const double tSingle = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        POP_RANGE
+
+        PUSH_RANGE("batched", 1);
+        t0 = std::chrono::steady_clock::now(); // The batch buffers are part of the batched cost
+        Ensemble ens(K);
+        ens.gather(batched.data());
+        ens.solve();
+        ens.scatter(batched.data());
+        const double tBatched = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        POP_RANGE
+
+        float diff = 0.0f;
+        for (int k = 0; k < K; ++k) {
+            for (int o = 0; o < NUM_OBJ; ++o) {
+                for (int j = 0; j < SIZE; ++j) {
+                    diff = std::max(diff, std::fabs(single[k].objs[o].value[j] - batched[k].objs[o].value[j]));
+                }
+            }
+        }
+        printf("%9d | %16.3e | %16.3e | %7.1fx | %.1e\n", K, K / tSingle, K / tBatched, tSingle / tBatched, diff);
+    }
+
+    return 0;
+}
@@ -0,0 +1,460 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Lazy expression templates fusing chains of element-wise Point/Basic updates into one pass
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Point class containing an id and a dynamic float array (innerObject)
+class Point
+{
+    private:
+        int pID;      // Unique identifier for the Point
+        int dataSize; // Size of the data array in elements
+        float* pData; // Data pointer as a dynamic array of floats
+    public:
+        int getId() const { return pID; }
+        int getDataSize() const { return dataSize; }
+        float* getData() const { return pData; }
+        // Sets the point ID and reserves memory for the data array (host and device)
+        void setPoint(int id, int n) {
+            this->pID = id;
+            this->dataSize = n;
+            this->pData = (float*)calloc(n, sizeof(float));
+            #pragma acc enter data copyin(pData[0:dataSize])
+        }
+};
+
+// Line class contains an array of Point objects (outerObject)
+class Line
+{
+    private:
+        int lID;       // Unique identifier for the Line
+        int nPoints;   // Number of Point objects in this Line
+        Point* points; // Pointer to an array of Point objects
+    public:
+        int getId() const { return lID; }
+        int getNPoints() const { return nPoints; }
+        Point* getPoints() const { return points; }
+        // Sets the line ID and reserves memory for the Point array (host and device)
+        void setLine(int id, int np, int ndata) {
+            this->lID = id;
+            this->nPoints = np;
+            this->points = (Point*)calloc(np, sizeof(Point));
+            #pragma acc enter data copyin(points[0:nPoints])
+            for (int i = 0; i < np; ++i) {
+                points[i].setPoint(lID * np + i, ndata);
+            }
+        }
+};
+
+// Simple struct containing an int and a dynamic float array (as in aos_with_dynamic_arrays)
+struct Basic
+{
+    int id;
+    float* value = nullptr;
+};
+
+/*
+ * Expression templates
+ *
+ * Every node is a small trivially copyable struct with an eval(i, j, k) method returning
+ * the value of the expression at one element. Building an expression only records the
+ * operations in its type; nothing is computed until it is assigned to a field, at which
+ * point a single loop nest evaluates the whole tree per element: one read and one write
+ * of each payload entry, however many operations the chain contains.
+ *
+ * Index convention: (i, j, k) = (line, point, component) for Point payloads and
+ * (i, j, 0) = (object, entry) for Basic payloads.
+ */
+
+// CRTP tag identifying expression nodes
+template <class E>
+struct Expr
+{
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+// Constant leaf
+struct Scalar : public Expr<Scalar>
+{
+    float v;
+    explicit Scalar(float value) : v(value) {}
+    float eval(int, int, int) const { return v; }
+};
+
+// Leaf returning one of the loop indices (D = 0, 1, 2 for i, j, k)
+template <int D>
+struct Index : public Expr<Index<D>>
+{
+    float eval(int i, int j, int k) const {
+        return static_cast<float>(D == 0 ? i : (D == 1 ? j : k));
+    }
+};
+
+// Binary operations
+struct OpAdd { static float apply(float a, float b) { return a + b; } };
+struct OpSub { static float apply(float a, float b) { return a - b; } };
+struct OpMul { static float apply(float a, float b) { return a * b; } };
+
+// Interior node: operands are stored by value so the tree can be copied into a kernel
+template <class L, class R, class Op>
+struct BinaryExpr : public Expr<BinaryExpr<L, R, Op>>
+{
+    L l;
+    R r;
+    BinaryExpr(const L& lhs, const R& rhs) : l(lhs), r(rhs) {}
+    float eval(int i, int j, int k) const {
+        return Op::apply(l.eval(i, j, k), r.eval(i, j, k));
+    }
+};
+
+// Operator overloads: expression (op) expression, expression (op) float, float (op) expression
+#define DEFINE_EXPR_OPERATOR(sym, Op) \
+template <class L, class R> \
+BinaryExpr<L, R, Op> operator sym(const Expr<L>& a, const Expr<R>& b) { \
+    return BinaryExpr<L, R, Op>(a.self(), b.self()); \
+} \
+template <class L> \
+BinaryExpr<L, Scalar, Op> operator sym(const Expr<L>& a, float b) { \
+    return BinaryExpr<L, Scalar, Op>(a.self(), Scalar(b)); \
+} \
+template <class R> \
+BinaryExpr<Scalar, R, Op> operator sym(float a, const Expr<R>& b) { \
+    return BinaryExpr<Scalar, R, Op>(Scalar(a), b.self()); \
+}
+
+DEFINE_EXPR_OPERATOR(+, OpAdd)
+DEFINE_EXPR_OPERATOR(-, OpSub)
+DEFINE_EXPR_OPERATOR(*, OpMul)
+
+// Device address of an array already present on the device (the array itself in host builds).
+// Leaves are copied by value into the kernels, so they must carry device addresses.
+template <class T>
+T* deviceAddress(T* p)
+{
+#ifndef NOACC
+    return static_cast<T*>(acc_deviceptr(p));
+#else
+    return p;
+#endif
+}
+
+// Leaf/target over the Point payloads of an array of Lines
+class PointField : public Expr<PointField>
+{
+    private:
+        Line* lines;  // Array of Line objects (host and device)
+        Line* dLines; // Device address of lines, used by eval inside kernels
+        int nlines;   // Number of lines
+        int np;       // Points per line
+        int ndata;    // Data entries per point
+    public:
+        PointField(Line* l, int nl, int npts, int nd)
+            : lines(l), dLines(deviceAddress(l)), nlines(nl), np(npts), ndata(nd) {}
+
+        float eval(int i, int j, int k) const {
+            return dLines[i].getPoints()[j].getData()[k];
+        }
+
+        // Materialize an expression: one fused traversal over all payloads
+        template <class E>
+        void assign(const Expr<E>& expr) {
+            const E e = expr.self();
+            Line* l = lines;
+            const int nl = nlines;
+            const int npts = np;
+            const int nd = ndata;
+            PUSH_RANGE("PointField::assign", 0);
+            #pragma acc parallel loop gang present(l[0:nl]) firstprivate(e)
+            for (int i = 0; i < nl; ++i) {
+                Point* points = l[i].getPoints();
+                #pragma acc loop vector
+                for (int j = 0; j < npts; ++j) {
+                    float* data = points[j].getData();
+                    #pragma acc loop seq
+                    for (int k = 0; k < nd; ++k) {
+                        data[k] = e.eval(i, j, k);
+                    }
+                }
+            }
+            POP_RANGE
+        }
+
+        template <class E>
+        PointField& operator=(const Expr<E>& expr) {
+            assign(expr);
+            return *this;
+        }
+};
+
+// Leaf/target over the value arrays of an array of Basic structs
+class BasicField : public Expr<BasicField>
+{
+    private:
+        Basic* objs;  // Array of Basic structs (host and device)
+        Basic* dObjs; // Device address of objs, used by eval inside kernels
+        int nobj;     // Number of structs
+        int size;     // Entries per value array
+    public:
+        BasicField(Basic* b, int n, int s) : objs(b), dObjs(deviceAddress(b)), nobj(n), size(s) {}
+
+        float eval(int i, int j, int) const {
+            return dObjs[i].value[j];
+        }
+
+        // Materialize an expression: one fused traversal over all value arrays
+        template <class E>
+        void assign(const Expr<E>& expr) {
+            const E e = expr.self();
+            Basic* b = objs;
+            const int n = nobj;
+            const int s = size;
+            PUSH_RANGE("BasicField::assign", 1);
+            #pragma acc parallel loop gang present(b[0:n]) firstprivate(e)
+            for (int i = 0; i < n; ++i) {
+                float* value = b[i].value;
+                #pragma acc loop vector
+                for (int j = 0; j < s; ++j) {
+                    value[j] = e.eval(i, j, 0);
+                }
+            }
+            POP_RANGE
+        }
+
+        template <class E>
+        BasicField& operator=(const Expr<E>& expr) {
+            assign(expr);
+            return *this;
+        }
+};
+
+// Wall-clock helper
+static double seconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Build an array of Line objects on host and device
+static Line* buildLines(int nlines, int np, int ndata)
+{
+    Line* lines = (Line*)calloc(nlines, sizeof(Line));
+    #pragma acc enter data copyin(lines[0:nlines])
+    for (int i = 0; i < nlines; ++i) {
+        lines[i].setLine(i, np, ndata);
+    }
+    return lines;
+}
+
+// Build an array of Basic structs on host and device
+static Basic* buildBasics(int nobj, int size)
+{
+    Basic* objs = (Basic*)malloc(nobj * sizeof(Basic));
+    for (int i = 0; i < nobj; ++i) {
+        objs[i].id = i;
+        objs[i].value = (float*)calloc(size, sizeof(float));
+    }
+    #pragma acc enter data copyin(objs[0:nobj])
+    for (int i = 0; i < nobj; ++i) {
+        #pragma acc enter data copyin(objs[i].value[0:size])
+    }
+    return objs;
+}
+
+// The two separate passes of array_of_objects (kernel_1 and kernel_2)
+static void unfusedLines(Line* lines, int nlines, int np, int ndata)
+{
+    #pragma acc parallel loop gang present(lines[0:nlines])
+    for (int i = 0; i < nlines; ++i) {
+        Point* points = lines[i].getPoints();
+        #pragma acc loop vector
+        for (int j = 0; j < np; ++j) {
+            float* data = points[j].getData();
+            for (int k = 0; k < ndata; ++k) {
+                data[k] += static_cast<float>(1);
+            }
+        }
+    }
+    #pragma acc parallel loop gang present(lines[0:nlines])
+    for (int i = 0; i < nlines; ++i) {
+        Point* points = lines[i].getPoints();
+        #pragma acc loop vector
+        for (int j = 0; j < np; ++j) {
+            float* data = points[j].getData();
+            #pragma acc loop seq
+            for (int k = 0; k < ndata; ++k) {
+                data[k] += static_cast<float>(i+j+k);
+            }
+        }
+    }
+}
+
+// The two separate passes of aos_with_dynamic_arrays
+static void unfusedBasics(Basic* objs, int nobj, int size)
+{
+    #pragma acc parallel loop gang present(objs[0:nobj])
+    for (int i = 0; i < nobj; ++i) {
+        #pragma acc loop vector
+        for (int j = 0; j < size; ++j) {
+            objs[i].value[j] += 2.0f + (float) j + (float) i;
+        }
+    }
+    #pragma acc parallel loop gang present(objs[0:nobj])
+    for (int i = 0; i < nobj; ++i) {
+        #pragma acc loop vector
+        for (int j = 0; j < size; ++j) {
+            objs[i].value[j] *= 2.0f;
+        }
+    }
+}
+
+// Largest absolute difference between two Line payload sets (host copies)
+static float maxDiffLines(Line* a, Line* b, int nlines, int np, int ndata)
+{
+    float diff = 0.0f;
+    for (int i = 0; i < nlines; ++i) {
+        for (int j = 0; j < np; ++j) {
+            float* da = a[i].getPoints()[j].getData();
+            float* db = b[i].getPoints()[j].getData();
+            #pragma acc update self(da[0:ndata], db[0:ndata])
+            for (int k = 0; k < ndata; ++k) {
+                diff = fmaxf(diff, fabsf(da[k] - db[k]));
+            }
+        }
+    }
+    return diff;
+}
+
+// Largest absolute difference between two Basic payload sets (host copies)
+static float maxDiffBasics(Basic* a, Basic* b, int nobj, int size)
+{
+    float diff = 0.0f;
+    for (int i = 0; i < nobj; ++i) {
+        float* va = a[i].value;
+        float* vb = b[i].value;
+        #pragma acc update self(va[0:size], vb[0:size])
+        for (int j = 0; j < size; ++j) {
+            diff = fmaxf(diff, fabsf(va[j] - vb[j]));
+        }
+    }
+    return diff;
+}
+
+int main(int argc, const char** argv)
+{
+    // Problem parameters (large enough to be bandwidth-bound)
+    const int nlines = (argc > 1) ? atoi(argv[1]) : 4096; // Number of lines
+    const int np = (argc > 2) ? atoi(argv[2]) : 256;      // Points per line
+    const int ndata = 4;                                  // Data entries per point
+    const int nobj = nlines;                              // Number of Basic structs
+    const int size = 1024;                                // Entries per Basic value array
+    const int nrep = 10;                                  // Timed repetitions
+
+    PUSH_RANGE("main::allocate", 0);
+    Line* linesRef = buildLines(nlines, np, ndata);
+    Line* linesFused = buildLines(nlines, np, ndata);
+    Basic* basicRef = buildBasics(nobj, size);
+    Basic* basicFused = buildBasics(nobj, size);
+    POP_RANGE
+
+    PointField f(linesFused, nlines, np, ndata);
+    BasicField b(basicFused, nobj, size);
+
+    // Expressions are only recorded here: f and b are untouched
+    auto lineUpdate = f + 1.0f + Index<0>() + Index<1>() + Index<2>();
+    auto basicUpdate = (b + 2.0f + Index<1>() + Index<0>()) * 2.0f;
+
+    // Two passes per update, as in the original examples
+    PUSH_RANGE("main::unfused", 1);
+    double t0 = seconds();
+    for (int r = 0; r < nrep; ++r) {
+        unfusedLines(linesRef, nlines, np, ndata);
+    }
+    double t1 = seconds();
+    for (int r = 0; r < nrep; ++r) {
+        unfusedBasics(basicRef, nobj, size);
+    }
+    double t2 = seconds();
+    POP_RANGE
+
+    // One fused pass per update
+    PUSH_RANGE("main::fused", 2);
+    double t3 = seconds();
+    for (int r = 0; r < nrep; ++r) {
+        f = lineUpdate;
+    }
+    double t4 = seconds();
+    for (int r = 0; r < nrep; ++r) {
+        b = basicUpdate;
+    }
+    double t5 = seconds();
+    POP_RANGE
+
+    // Bytes of payload touched per update: 2 passes x (read + write) vs 1 x (read + write)
+    const double lineBytes = 2.0 * nlines * np * ndata * sizeof(float);
+    const double basicBytes = 2.0 * nobj * size * sizeof(float);
+
+    printf("Array of objects: %d lines x %d points x %d entries\n", nlines, np, ndata);
+    printf("  unfused (2 passes): %10.3f ms/update, %8.2f GB/s effective\n",
+           1e3 * (t1 - t0) / nrep, nrep * lineBytes / (t1 - t0) * 1e-9);
+    printf("  fused   (1 pass)  : %10.3f ms/update, %8.2f GB/s effective\n",
+           1e3 * (t4 - t3) / nrep, nrep * lineBytes / (t4 - t3) * 1e-9);
+    printf("  speedup %.2fx, max |diff| = %e\n", (t1 - t0) / (t4 - t3),
+           maxDiffLines(linesRef, linesFused, nlines, np, ndata));
+
+    printf("AoS with dynamic arrays: %d objects x %d entries\n", nobj, size);
+    printf("  unfused (2 passes): %10.3f ms/update, %8.2f GB/s effective\n",
+           1e3 * (t2 - t1) / nrep, nrep * basicBytes / (t2 - t1) * 1e-9);
+    printf("  fused   (1 pass)  : %10.3f ms/update, %8.2f GB/s effective\n",
+           1e3 * (t5 - t4) / nrep, nrep * basicBytes / (t5 - t4) * 1e-9);
+    printf("  speedup %.2fx, max |diff| = %e\n", (t2 - t1) / (t5 - t4),
+           maxDiffBasics(basicRef, basicFused, nobj, size));
+
+    return 0;
+}
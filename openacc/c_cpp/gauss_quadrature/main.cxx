@@ -0,0 +1,409 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Compile-time Gauss-Legendre and Gauss-Lobatto tables for Lines templated on the quadrature order
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// constexpr math helpers (std::cos and std::fabs are not constexpr in C++20)
+constexpr double cxPi = 3.14159265358979323846;
+
+constexpr double cxAbs(double x) { return x < 0.0 ? -x : x; }
+
+// Taylor series of cos, with the argument reduced to [-pi, pi]
+constexpr double cxCos(double x)
+{
+    while (x > cxPi) {
+        x -= 2.0 * cxPi;
+    }
+    while (x < -cxPi) {
+        x += 2.0 * cxPi;
+    }
+    double term = 1.0, sum = 1.0;
+    for (int k = 1; k < 40; ++k) {
+        term *= -x * x / ((2.0 * k - 1.0) * (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// Legendre polynomial P_n(x) and its derivative, by the three-term recurrence
+constexpr void legendre(int n, double x, double& p, double& dp)
+{
+    double p0 = 1.0, p1 = x;
+    if (n == 0) {
+        p = 1.0;
+        dp = 0.0;
+        return;
+    }
+    for (int k = 2; k <= n; ++k) {
+        const double p2 = ((2.0 * k - 1.0) * x * p1 - (k - 1.0) * p0) / k;
+        p0 = p1;
+        p1 = p2;
+    }
+    p = p1;
+    dp = n * (x * p1 - p0) / (x * x - 1.0);
+}
+
+// Gauss-Legendre rule with n points: roots of P_n by Newton, w = 2 / ((1 - x^2) P_n'(x)^2)
+// Works both at compile time and at run time
+constexpr void gaussLegendre(int n, double* x, double* w)
+{
+    for (int i = 0; i < (n + 1) / 2; ++i) {
+        double xi = cxCos(cxPi * (i + 0.75) / (n + 0.5));
+        double p = 0.0, dp = 1.0;
+        for (int it = 0; it < 100; ++it) {
+            legendre(n, xi, p, dp);
+            const double dx = p / dp;
+            xi -= dx;
+            if (cxAbs(dx) < 1e-16) {
+                break;
+            }
+        }
+        legendre(n, xi, p, dp);
+        x[i] = -xi;
+        x[n - 1 - i] = xi;
+        w[i] = w[n - 1 - i] = 2.0 / ((1.0 - xi * xi) * dp * dp);
+    }
+    if (n % 2 == 1) {
+        x[n / 2] = 0.0;
+    }
+}
+
+// Gauss-Lobatto rule with n >= 2 points: the end points plus the roots of P_{n-1}',
+// w = 2 / (n (n - 1) P_{n-1}(x)^2)
+constexpr void gaussLobatto(int n, double* x, double* w)
+{
+    const int m = n - 1;
+    x[0] = -1.0;
+    x[m] = 1.0;
+    w[0] = w[m] = 2.0 / (n * m);
+    for (int i = 1; i < (n + 1) / 2; ++i) {
+        double xi = cxCos(cxPi * i / m);
+        double p = 0.0, dp = 0.0;
+        for (int it = 0; it < 100; ++it) {
+            legendre(m, xi, p, dp);
+            // Newton on P_m', with P_m'' = (2 x P_m' - m (m + 1) P_m) / (1 - x^2)
+            const double d2p = (2.0 * xi * dp - m * (m + 1.0) * p) / (1.0 - xi * xi);
+            const double dx = dp / d2p;
+            xi -= dx;
+            if (cxAbs(dx) < 1e-16) {
+                break;
+            }
+        }
+        legendre(m, xi, p, dp);
+        x[i] = -xi;
+        x[m - i] = xi;
+        w[i] = w[m - i] = 2.0 / (n * m * p * p);
+    }
+    if (n % 2 == 1) {
+        double p = 0.0, dp = 0.0;
+        legendre(m, 0.0, p, dp);
+        x[n / 2] = 0.0;
+        w[n / 2] = 2.0 / (n * m * p * p);
+    }
+}
+
+// Quadrature table on [-1, 1]
+template <int N>
+struct QuadTable
+{
+    double x[N];
+    double w[N];
+};
+
+// Compile-time rules: the tables are constants in the binary, nothing runs at start-up
+template <int N>
+struct GaussLegendre
+{
+    static constexpr const char* name = "Gauss-Legendre";
+    static constexpr int exactDegree = 2 * N - 1;
+    static constexpr QuadTable<N> table = [] {
+        QuadTable<N> t{};
+        gaussLegendre(N, t.x, t.w);
+        return t;
+    }();
+    static void compute(int n, double* x, double* w) { gaussLegendre(n, x, w); }
+};
+
+template <int N>
+struct GaussLobatto
+{
+    static_assert(N >= 2, "Gauss-Lobatto needs at least the two end points");
+    static constexpr const char* name = "Gauss-Lobatto";
+    static constexpr int exactDegree = 2 * N - 3;
+    static constexpr QuadTable<N> table = [] {
+        QuadTable<N> t{};
+        gaussLobatto(N, t.x, t.w);
+        return t;
+    }();
+    static void compute(int n, double* x, double* w) { gaussLobatto(n, x, w); }
+};
+
+// Checked by the compiler
+static_assert(cxAbs(GaussLegendre<2>::table.x[1] - 0.5773502691896257) < 1e-15, "GL2 point");
+static_assert(cxAbs(GaussLegendre<2>::table.w[0] - 1.0) < 1e-15, "GL2 weight");
+static_assert(cxAbs(GaussLegendre<3>::table.w[1] - 8.0 / 9.0) < 1e-15, "GL3 weight");
+static_assert(cxAbs(GaussLobatto<3>::table.w[1] - 4.0 / 3.0) < 1e-15, "GLL3 weight");
+
+// Calls f(std::integral_constant<int, q>) for q = 0..N-1, fully unrolled
+template <int N, class F>
+inline void staticFor(F&& f)
+{
+    [&]<int... Q>(std::integer_sequence<int, Q...>) {
+        (f(std::integral_constant<int, Q>{}), ...);
+    }(std::make_integer_sequence<int, N>{});
+}
+
+// Point class (fixed-size members only, so arrays of them copy to the device in one piece)
+class Point
+{
+    protected:
+        int pID;    // Point ID
+        float x;    // Coordinate along the line
+        float data; // Data field
+    public:
+        void setPoint(int id, float xc) {
+            pID = id;
+            x = xc;
+            data = 0.0f;
+        }
+        float getX() const { return x; }
+        float getData() const { return data; }
+        void setData(float v) { data = v; }
+};
+
+// Child GaussPoint class: reference position and weight come from the quadrature rule
+class GaussPoint : public Point
+{
+    private:
+        float xi;       // Position on the reference line [-1, 1]
+        float gpWeight; // Quadrature weight on the reference line
+    public:
+        void setGaussPoint(int id, float xc, float ref, float weight) {
+            this->setPoint(id, xc);
+            xi = ref;
+            gpWeight = weight;
+        }
+        float getXi() const { return xi; }
+        float getWeight() const { return gpWeight; }
+};
+
+/**
+ * @brief Line element templated on the number of Gauss points and on the rule
+ *
+ * The Gauss points are a fixed-size member array, their positions and weights are set from the
+ * compile-time table, and integrate() uses the table directly with a fully unrolled loop.
+ */
+template <int Q, template <int> class Rule = GaussLegendre>
+class Line
+{
+    private:
+        int lineID;
+        Point nodes[2];
+        GaussPoint gaussPoints[Q];
+    public:
+        static constexpr int numGaussPoints = Q;
+
+        // Set the line from the compile-time table (host only)
+        void setLine(int id, float x0, float x1) {
+            lineID = id;
+            nodes[0].setPoint(2 * id, x0);
+            nodes[1].setPoint(2 * id + 1, x1);
+            constexpr QuadTable<Q> t = Rule<Q>::table;
+            const float xm = 0.5f * (x0 + x1), hw = 0.5f * (x1 - x0);
+            staticFor<Q>([&](auto q) {
+                gaussPoints[q].setGaussPoint(id * Q + q, xm + hw * (float)t.x[q], (float)t.x[q], (float)t.w[q]);
+            });
+        }
+
+        // Same, but computing the rule at run time as a mesh generator without tables would (host only)
+        // Rejects orders other than Q, which would leave Gauss points without a node and weight
+        bool setLineRuntime(int id, float x0, float x1, int q) {
+            if (q != Q) {
+                return false;
+            }
+            lineID = id;
+            nodes[0].setPoint(2 * id, x0);
+            nodes[1].setPoint(2 * id + 1, x1);
+            double x[Q], w[Q];
+            Rule<Q>::compute(q, x, w);
+            const float xm = 0.5f * (x0 + x1), hw = 0.5f * (x1 - x0);
+            for (int i = 0; i < Q; ++i) {
+                gaussPoints[i].setGaussPoint(id * Q + i, xm + hw * (float)x[i], (float)x[i], (float)w[i]);
+            }
+            return true;
+        }
+
+        GaussPoint& gaussPoint(int q) { return gaussPoints[q]; }
+
+        // Integral of the Gauss point data over the line (host/device callable, unrolled)
+        float integrate() const {
+            constexpr QuadTable<Q> t = Rule<Q>::table;
+            const float jac = 0.5f * (nodes[1].getX() - nodes[0].getX());
+            float sum = 0.0f;
+            staticFor<Q>([&](auto q) {
+                sum += (float)t.w[q] * gaussPoints[q].getData();
+            });
+            return jac * sum;
+        }
+};
+
+// Largest error integrating x^k over [-1, 1] for k up to the rule's exact degree
+template <int N, template <int> class Rule>
+double monomialError()
+{
+    constexpr QuadTable<N> t = Rule<N>::table;
+    double err = 0.0;
+    for (int k = 0; k <= Rule<N>::exactDegree; ++k) {
+        double sum = 0.0;
+        for (int q = 0; q < N; ++q) {
+            sum += t.w[q] * std::pow(t.x[q], k);
+        }
+        const double exact = (k % 2 == 0) ? 2.0 / (k + 1) : 0.0;
+        err = std::max(err, std::fabs(sum - exact));
+    }
+    return err;
+}
+
+template <int N>
+void printRules()
+{
+    printf("%3d | %-10.3e | ", N, monomialError<N, GaussLegendre>());
+    if constexpr (N >= 2) {
+        printf("%-10.3e | ", monomialError<N, GaussLobatto>());
+    } else {
+        printf("%-10s | ", "-");
+    }
+    for (int q = 0; q < std::min(N, 4); ++q) {
+        printf("%+.6f/%.6f ", GaussLegendre<N>::table.x[q], GaussLegendre<N>::table.w[q]);
+    }
+    printf("\n");
+}
+
+// Mesh initialization time with compile-time tables vs rules computed per element
+template <int Q, template <int> class Rule>
+void benchmarkSetup(int nlines, int qRuntime)
+{
+    if (qRuntime != Q) {
+        fprintf(stderr, "Skipping setup benchmark for Q = %d: run-time order %d does not match\n", Q, qRuntime);
+        return;
+    }
+    Line<Q, Rule>* lines = (Line<Q, Rule>*)calloc(nlines, sizeof(Line<Q, Rule>));
+    const float h = 1.0f / nlines;
+
+    PUSH_RANGE("setup::runtime", 0);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < nlines; ++i) {
+        lines[i].setLineRuntime(i, i * h, (i + 1) * h, qRuntime);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    POP_RANGE
+    const float check = lines[nlines - 1].gaussPoint(Q - 1).getWeight();
+
+    PUSH_RANGE("setup::constexpr", 1);
+    auto t2 = std::chrono::steady_clock::now();
+    for (int i = 0; i < nlines; ++i) {
+        lines[i].setLine(i, i * h, (i + 1) * h);
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    POP_RANGE
+
+    // Integrate f(x) = x^(2Q-3) over [0, 1] on the device
+    const int deg = 2 * Q - 3;
+    for (int i = 0; i < nlines; ++i) {
+        for (int q = 0; q < Q; ++q) {
+            lines[i].gaussPoint(q).setData(std::pow(lines[i].gaussPoint(q).getX(), deg));
+        }
+    }
+    double total = 0.0;
+    PUSH_RANGE("integrate", 2);
+    #pragma acc parallel loop copyin(lines[0:nlines]) reduction(+:total)
+    for (int i = 0; i < nlines; ++i) {
+        total += lines[i].integrate();
+    }
+    POP_RANGE
+
+    const double tr = std::chrono::duration<double>(t1 - t0).count();
+    const double tc = std::chrono::duration<double>(t3 - t2).count();
+    printf("%-14s Q=%2d: runtime setup %8.3f ms, constexpr setup %8.3f ms (%5.1fx), weight check %s, int x^%d = %.6f (exact %.6f)\n",
+           Rule<Q>::name, Q, 1e3 * tr, 1e3 * tc, tr / tc,
+           (check == lines[nlines - 1].gaussPoint(Q - 1).getWeight()) ? "ok" : "MISMATCH",
+           deg, total, 1.0 / (deg + 1));
+    free(lines);
+}
+
+int main(int argc, const char** argv)
+{
+    const int nlines = (argc > 1) ? atoi(argv[1]) : 200000; // Number of lines
+
+    printf("  N | GL error   | GLL error  | first GL points/weights\n");
+    printRules<1>();
+    printRules<2>();
+    printRules<3>();
+    printRules<4>();
+    printRules<5>();
+    printRules<8>();
+    printRules<12>();
+    printRules<16>();
+    printRules<24>();
+    printf("\n");
+
+    // The run-time order is read from argc so the runtime setup cannot be folded into constants
+    const int offset = (argc > 2) ? atoi(argv[2]) : 0;
+    benchmarkSetup<2, GaussLegendre>(nlines, 2 + offset);
+    benchmarkSetup<4, GaussLegendre>(nlines, 4 + offset);
+    benchmarkSetup<8, GaussLegendre>(nlines, 8 + offset);
+    benchmarkSetup<4, GaussLobatto>(nlines, 4 + offset);
+    benchmarkSetup<8, GaussLobatto>(nlines, 8 + offset);
+
+    return 0;
+}
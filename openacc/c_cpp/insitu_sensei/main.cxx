@@ -0,0 +1,593 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief In-situ analysis adaptor for Line/Point data: SENSEI when USE_SENSEI is set, POSIX shared-memory ring otherwise
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// POSIX headers
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+#ifdef USE_SENSEI
+// MPI and SENSEI headers
+#include <mpi.h>
+#include <ConfigurableAnalysis.h>
+#include <DataAdaptor.h>
+#include <MeshMetadata.h>
+#include <svtkCellArray.h>
+#include <svtkFloatArray.h>
+#include <svtkIntArray.h>
+#include <svtkPointData.h>
+#include <svtkPoints.h>
+#include <svtkPolyData.h>
+#endif
+
+// Point class whose coordinates and payload live in buffers shared by the whole mesh
+class Point
+{
+    private:
+        int pID;      // Unique identifier for the Point
+        int dataSize; // Size of the data array in elements
+        float* xyz;   // Coordinates, inside the mesh coordinate buffer
+        float* pData; // Payload, inside the mesh payload buffer
+    public:
+        int getId() const { return pID; }
+        float* getData() const { return pData; }
+        const float* getCoords() const { return xyz; }
+        void setPoint(int id, int n, float* coords, float* data) {
+            pID = id;
+            dataSize = n;
+            xyz = coords;
+            pData = data;
+            #pragma acc enter data copyin(xyz[0:3], pData[0:dataSize]) // Already present: only attaches
+        }
+};
+
+// Line class contains an array of Point objects
+class Line
+{
+    private:
+        int lID;       // Unique identifier for the Line
+        int nPoints;   // Number of Point objects in this Line
+        Point* points; // Pointer to an array of Point objects
+    public:
+        int getNPoints() const { return nPoints; }
+        Point* getPoints() const { return points; }
+        void setLine(int id, int np, int ndata, float* coords, float* data) {
+            lID = id;
+            nPoints = np;
+            points = (Point*)calloc(np, sizeof(Point));
+            #pragma acc enter data copyin(points[0:nPoints])
+            for (int i = 0; i < np; ++i) {
+                const int pid = lID * np + i;
+                points[i].setPoint(pid, ndata, coords + 3L * pid, data + (long)ndata * pid);
+            }
+        }
+};
+
+/**
+ * @brief Zero-copy description of the mesh handed to the analysis
+ *
+ * Point p of line l has id l * pointsPerLine + p, coordinates xyz[3 * id : 3 * id + 3] and
+ * payload data[ndata * id : ndata * id + ndata]. These are the host buffers of the simulation.
+ */
+struct MeshView
+{
+    int nlines;
+    int pointsPerLine;
+    int ndata;
+    const float* xyz;
+    const float* data;
+    long numPoints() const { return (long)nlines * pointsPerLine; }
+};
+
+// In-situ adaptor interface: the simulation only sees these three calls
+class InSituAdaptor
+{
+    public:
+        virtual ~InSituAdaptor() {}
+        virtual bool initialize(const MeshView& mesh) = 0;
+        virtual void execute(const MeshView& mesh, int step, double time) = 0;
+        virtual void finalize() = 0;
+};
+
+/**
+ * @brief Layout of the shared-memory ring: a header followed by nslots snapshot slots
+ *
+ * Each slot is protected by a sequence lock. The producer makes the sequence odd, writes,
+ * then makes it even again; a reader that sees the same even value before and after its copy
+ * knows the copy is consistent. The producer never waits for readers.
+ */
+struct RingHeader
+{
+    uint64_t magic;
+    uint32_t nslots;
+    uint32_t ndata;
+    uint64_t npoints;
+    uint64_t slotBytes;
+    std::atomic<uint64_t> published; // Snapshots published so far
+    std::atomic<uint32_t> finished;  // Set by the producer when the run ends
+};
+
+struct SlotHeader
+{
+    std::atomic<uint64_t> seq; // 2 * ticket + 1 while writing, 2 * ticket + 2 when complete
+    int32_t step;
+    float time;
+};
+
+const uint64_t RING_MAGIC = 0x4f4f50494e534954ULL;
+
+inline size_t slotStride(uint64_t npoints, uint32_t ndata)
+{
+    return (sizeof(SlotHeader) + npoints * ndata * sizeof(float) + 63) / 64 * 64;
+}
+
+// Local stand-in for SENSEI: snapshots exported to a POSIX shared-memory ring
+class ShmRingAdaptor : public InSituAdaptor
+{
+    private:
+        std::string name;
+        uint32_t nslots;
+        size_t bytes;
+        char* base;
+        RingHeader* header;
+    public:
+        double exportTime = 0.0;
+
+        ShmRingAdaptor(const char* shmName, uint32_t slots) : name(shmName), nslots(slots), bytes(0), base(nullptr), header(nullptr) {}
+
+        bool initialize(const MeshView& mesh) override {
+            const size_t stride = slotStride(mesh.numPoints(), mesh.ndata);
+            bytes = sizeof(RingHeader) + 64 + nslots * stride;
+            shm_unlink(name.c_str());
+            const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+            if (fd < 0 || ftruncate(fd, bytes) != 0) {
+                perror("shm_open/ftruncate");
+                return false;
+            }
+            base = (char*)mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (base == MAP_FAILED) {
+                perror("mmap");
+                return false;
+            }
+            header = new (base) RingHeader();
+            header->nslots = nslots;
+            header->ndata = mesh.ndata;
+            header->npoints = mesh.numPoints();
+            header->slotBytes = stride;
+            header->published.store(0);
+            header->finished.store(0);
+            for (uint32_t s = 0; s < nslots; ++s) {
+                new (slot(s)) SlotHeader();
+                slot(s)->seq.store(0);
+            }
+            // The magic goes last: readers wait for it before trusting the header
+            std::atomic_thread_fence(std::memory_order_release);
+            header->magic = RING_MAGIC;
+            return true;
+        }
+
+        // One copy from the device payload straight into the next slot; never blocks
+        // (host-only builds copy from the simulation's host buffer instead)
+        void execute(const MeshView& mesh, int step, double time) override {
+            auto t0 = std::chrono::steady_clock::now();
+            const uint64_t ticket = header->published.load(std::memory_order_relaxed);
+            SlotHeader* s = slot(ticket % nslots);
+            s->seq.store(2 * ticket + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            s->step = step;
+            s->time = (float)time;
+            const size_t n = mesh.numPoints() * mesh.ndata * sizeof(float);
+#ifndef NOACC
+            acc_memcpy_from_device(payload(s), acc_deviceptr((void*)mesh.data), n);
+#else
+            memcpy(payload(s), mesh.data, n);
+#endif
+            s->seq.store(2 * ticket + 2, std::memory_order_release);
+            header->published.store(ticket + 1, std::memory_order_release);
+            exportTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        }
+
+        void finalize() override {
+            if (header) {
+                header->finished.store(1, std::memory_order_release);
+                munmap(base, bytes);
+                header = nullptr;
+            }
+        }
+
+        void unlink() { shm_unlink(name.c_str()); }
+
+    private:
+        SlotHeader* slot(uint64_t s) const { return (SlotHeader*)(base + (sizeof(RingHeader) + 63) / 64 * 64 + s * header->slotBytes); }
+        static float* payload(SlotHeader* s) { return (float*)((char*)s + sizeof(SlotHeader)); }
+};
+
+#ifdef USE_SENSEI
+/**
+ * @brief SENSEI data adaptor exposing the Lines as a polydata mesh ("lines")
+ *
+ * Coordinates and payload are wrapped with SetArray(..., save = 1): SENSEI reads the
+ * simulation's buffers directly and never frees them.
+ */
+class LineDataAdaptor : public sensei::DataAdaptor
+{
+    public:
+        static LineDataAdaptor* New() { return new LineDataAdaptor; }
+        senseiTypeMacro(LineDataAdaptor, sensei::DataAdaptor);
+
+        void setMesh(const MeshView& m) { mesh = m; }
+
+        int GetNumberOfMeshes(unsigned int& numMeshes) override {
+            numMeshes = 1;
+            return 0;
+        }
+
+        int GetMeshMetadata(unsigned int, sensei::MeshMetadataPtr& md) override {
+            md->MeshName = "lines";
+            md->MeshType = SVTK_POLY_DATA;
+            md->BlockType = SVTK_POLY_DATA;
+            md->NumBlocks = 1;
+            md->NumPoints = mesh.numPoints();
+            md->NumCells = mesh.nlines;
+            md->NumArrays = 1;
+            md->ArrayName = { "data" };
+            md->ArrayCentering = { svtkDataObject::POINT };
+            md->ArrayComponents = { mesh.ndata };
+            md->ArrayType = { SVTK_FLOAT };
+            return 0;
+        }
+
+        int GetMesh(const std::string& meshName, bool structureOnly, svtkDataObject*& out) override {
+            if (meshName != "lines") {
+                return -1;
+            }
+            svtkPolyData* pd = svtkPolyData::New();
+            if (!structureOnly) {
+                svtkFloatArray* coords = svtkFloatArray::New();
+                coords->SetNumberOfComponents(3);
+                coords->SetArray(const_cast<float*>(mesh.xyz), 3 * mesh.numPoints(), 1);
+                svtkPoints* pts = svtkPoints::New();
+                pts->SetData(coords);
+                pd->SetPoints(pts);
+                coords->Delete();
+                pts->Delete();
+                // One polyline cell per Line
+                svtkCellArray* cells = svtkCellArray::New();
+                for (int l = 0; l < mesh.nlines; ++l) {
+                    cells->InsertNextCell(mesh.pointsPerLine);
+                    for (int i = 0; i < mesh.pointsPerLine; ++i) {
+                        cells->InsertCellPoint((svtkIdType)l * mesh.pointsPerLine + i);
+                    }
+                }
+                pd->SetLines(cells);
+                cells->Delete();
+            }
+            out = pd;
+            return 0;
+        }
+
+        int AddArray(svtkDataObject* obj, const std::string& meshName, int association, const std::string& arrayName) override {
+            svtkPolyData* pd = dynamic_cast<svtkPolyData*>(obj);
+            if (!pd || meshName != "lines" || association != svtkDataObject::POINT || arrayName != "data") {
+                return -1;
+            }
+            svtkFloatArray* a = svtkFloatArray::New();
+            a->SetName("data");
+            a->SetNumberOfComponents(mesh.ndata);
+            a->SetArray(const_cast<float*>(mesh.data), (svtkIdType)mesh.ndata * mesh.numPoints(), 1);
+            pd->GetPointData()->AddArray(a);
+            a->Delete();
+            return 0;
+        }
+
+        int ReleaseData() override { return 0; }
+
+    private:
+        MeshView mesh{};
+};
+
+// In-process analysis through SENSEI's configurable analysis (XML file from SENSEI_CONFIG)
+class SenseiAdaptor : public InSituAdaptor
+{
+    private:
+        LineDataAdaptor* data = nullptr;
+        sensei::ConfigurableAnalysis* analysis = nullptr;
+    public:
+        bool initialize(const MeshView& mesh) override {
+            const char* config = getenv("SENSEI_CONFIG");
+            data = LineDataAdaptor::New();
+            data->setMesh(mesh);
+            analysis = sensei::ConfigurableAnalysis::New();
+            data->SetCommunicator(MPI_COMM_WORLD);
+            analysis->SetCommunicator(MPI_COMM_WORLD);
+            return config && analysis->Initialize(config) == 0;
+        }
+        void execute(const MeshView& mesh, int step, double time) override {
+            data->setMesh(mesh);
+            data->SetDataTimeStep(step);
+            data->SetDataTime(time);
+            analysis->Execute(data, nullptr);
+            data->ReleaseData();
+        }
+        void finalize() override {
+            analysis->Finalize();
+            analysis->Delete();
+            data->Delete();
+        }
+};
+#endif
+
+/**
+ * @brief Analysis consumer in a separate process: attaches to the ring and analyses the
+ * newest complete snapshot whenever one appears
+ *
+ * Snapshots overwritten before the consumer got to them are counted as skipped, and copies
+ * invalidated by a concurrent write as torn (and retried with the newer snapshot).
+ */
+int runConsumer(const char* shmName, double timeout)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    auto elapsed = [&] { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); };
+    int fd = -1;
+    while ((fd = shm_open(shmName, O_RDONLY, 0)) < 0 && elapsed() < timeout) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (fd < 0) {
+        printf("[consumer] no ring named %s\n", shmName);
+        return 1;
+    }
+    struct stat st{};
+    while (fstat(fd, &st) == 0 && (size_t)st.st_size < sizeof(RingHeader) && elapsed() < timeout) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if ((size_t)st.st_size < sizeof(RingHeader)) {
+        printf("[consumer] ring %s was never sized by the producer\n", shmName);
+        close(fd);
+        return 1;
+    }
+    char* base = (char*)mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    RingHeader* h = (RingHeader*)base;
+    while (h->magic != RING_MAGIC && elapsed() < timeout) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const long nvals = (long)h->npoints * h->ndata;
+    std::vector<float> copy(nvals);
+    long analysed = 0, skipped = 0, torn = 0;
+    uint64_t next = 0;
+
+    while (true) {
+        const uint64_t published = h->published.load(std::memory_order_acquire);
+        if (published == next) {
+            if (h->finished.load(std::memory_order_acquire)) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue;
+        }
+        // Always go for the newest snapshot
+        const uint64_t ticket = published - 1;
+        SlotHeader* s = (SlotHeader*)(base + (sizeof(RingHeader) + 63) / 64 * 64 + (ticket % h->nslots) * h->slotBytes);
+        const uint64_t s1 = s->seq.load(std::memory_order_acquire);
+        if (s1 != 2 * ticket + 2) {
+            torn++;
+            continue;
+        }
+        const int step = s->step;
+        memcpy(copy.data(), (char*)s + sizeof(SlotHeader), nvals * sizeof(float));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s->seq.load(std::memory_order_relaxed) != s1) {
+            torn++;
+            continue;
+        }
+        skipped += (long)(ticket - next);
+        next = ticket + 1;
+        analysed++;
+
+        // The analysis: range and mean of field 0
+        float lo = copy[0], hi = copy[0];
+        double mean = 0.0;
+        for (long p = 0; p < (long)h->npoints; ++p) {
+            const float v = copy[p * h->ndata];
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+            mean += v;
+        }
+        mean /= h->npoints;
+        if (analysed % 50 == 1) {
+            printf("[consumer] step %6d: field 0 in [%.4f, %.4f], mean %.6f\n", step, lo, hi, mean);
+        }
+    }
+    printf("[consumer] %ld snapshots analysed, %ld skipped (overwritten before being read), %ld torn reads retried\n",
+           analysed, skipped, torn);
+    munmap(base, st.st_size);
+    return 0;
+}
+
+// Simulation step: payload relaxes towards a travelling wave
+void computeStep(Line* lines, int nlines, int np, int ndata, int step)
+{
+    #pragma acc parallel loop gang present(lines[0:nlines])
+    for (int l = 0; l < nlines; ++l) {
+        Point* pts = lines[l].getPoints();
+        #pragma acc loop vector
+        for (int i = 0; i < np; ++i) {
+            float* d = pts[i].getData();
+            const float x = pts[i].getCoords()[0];
+            for (int k = 0; k < ndata; ++k) {
+                d[k] += 0.05f * (sinf(x + 0.01f * step + k) - d[k]);
+            }
+        }
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    const char* mode = (argc > 1) ? argv[1] : "demo";
+    const char* shmName = "/gpu_oop_insitu";
+    int nlines = 1024, np = 64, ndata = 4, nsteps = 2000, every = 5;
+    for (int a = 2; a < argc; ++a) {
+        if (strcmp(argv[a], "--steps") == 0 && a + 1 < argc) {
+            nsteps = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--every") == 0 && a + 1 < argc) {
+            every = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--lines") == 0 && a + 1 < argc) {
+            nlines = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--name") == 0 && a + 1 < argc) {
+            shmName = argv[++a];
+        }
+    }
+
+    if (strcmp(mode, "consume") == 0) {
+        return runConsumer(shmName, 30.0);
+    }
+    if (strcmp(mode, "demo") == 0) {
+#ifndef USE_SENSEI
+        // Same binary as the analysis process, started on the same node
+        if (fork() == 0) {
+            return runConsumer(shmName, 30.0);
+        }
+#endif
+    } else if (strcmp(mode, "produce") != 0) {
+        printf("Usage: %s [demo|produce|consume] [--steps n] [--every n] [--lines n] [--name /shm]\n", argv[0]);
+        return 1;
+    }
+#ifdef USE_SENSEI
+    // ConfigurableAnalysis is collective: the analyses run in process, on MPI_COMM_WORLD
+    MPI_Init(nullptr, nullptr);
+#endif
+
+    // Mesh buffers: every Point points into these, so the host side is one contiguous view
+    const long npts = (long)nlines * np;
+    float* coords = (float*)calloc(3 * npts, sizeof(float));
+    float* data = (float*)calloc(npts * ndata, sizeof(float));
+    for (long p = 0; p < npts; ++p) {
+        coords[3 * p] = 0.01f * (float)(p % np);
+        coords[3 * p + 1] = 0.1f * (float)(p / np);
+    }
+    #pragma acc enter data copyin(coords[0:3*npts], data[0:npts*ndata])
+    Line* lines = (Line*)calloc(nlines, sizeof(Line));
+    #pragma acc enter data copyin(lines[0:nlines])
+    for (int l = 0; l < nlines; ++l) {
+        lines[l].setLine(l, np, ndata, coords, data);
+    }
+    const MeshView mesh = { nlines, np, ndata, coords, data };
+
+#ifdef USE_SENSEI
+    SenseiAdaptor adaptor;
+#else
+    ShmRingAdaptor adaptor(shmName, 4);
+#endif
+    if (!adaptor.initialize(mesh)) {
+        printf("In-situ adaptor initialization failed\n");
+#ifdef USE_SENSEI
+        MPI_Finalize();
+#endif
+        return 1;
+    }
+
+#ifdef USE_SENSEI
+    double tTransfer = 0.0;
+#endif
+    auto t0 = std::chrono::steady_clock::now();
+    for (int step = 1; step <= nsteps; ++step) {
+        PUSH_RANGE("main::compute", 0);
+        computeStep(lines, nlines, np, ndata, step);
+        POP_RANGE
+        if (step % every == 0) {
+            PUSH_RANGE("main::insitu", 1);
+#ifdef USE_SENSEI
+            // SENSEI reads the simulation's host buffers, which must be current
+            auto c0 = std::chrono::steady_clock::now();
+            #pragma acc update self(data[0:npts*ndata])
+            tTransfer += std::chrono::duration<double>(std::chrono::steady_clock::now() - c0).count();
+#endif
+            adaptor.execute(mesh, step, 0.01 * step);
+            POP_RANGE
+        }
+    }
+    const double tTotal = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    adaptor.finalize();
+
+#ifndef USE_SENSEI
+    printf("[producer] %d steps, %d snapshots of %.2f MB in %.3f s: export to the ring %.3f s (%.2f GB/s), never blocked\n",
+           nsteps, nsteps / every, 1e-6 * npts * ndata * sizeof(float), tTotal, adaptor.exportTime,
+           1e-9 * (nsteps / every) * npts * ndata * sizeof(float) / adaptor.exportTime);
+#else
+    printf("[producer] %d steps in %.3f s, device->host %.3f s\n", nsteps, tTotal, tTransfer);
+#endif
+
+#ifndef USE_SENSEI
+    if (strcmp(mode, "demo") == 0) {
+        int status = 0;
+        wait(&status);
+        adaptor.unlink();
+    }
+#else
+    MPI_Finalize();
+#endif
+    return 0;
+}
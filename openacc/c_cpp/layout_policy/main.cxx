@@ -0,0 +1,361 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Reflection-lite AoS/SoA layout policy for the Basic struct with identical accessor syntax
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <type_traits>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+#define SIZE 3
+
+/**
+ * @brief Reflection-lite: a struct is described once as a member list X(type, name, extent)
+ *
+ * REFLECT_STRUCT generates the plain struct (used by AoS) and a Reflect<> specialization
+ * describing its SoA columns and the proxy reference returned by SoA::operator[]. Extent 1
+ * declares a scalar member, anything larger a fixed-size array member.
+ */
+
+// Storage of a member inside the struct: T for scalars, T[N] for arrays
+template <class T, int N> struct FieldStorage { using type = T[N]; };
+template <class T> struct FieldStorage<T, 1> { using type = T; };
+
+// Proxy for an array member stored as N columns of n entries: value[j] -> col[j * n + i]
+template <class T>
+struct ColumnRef
+{
+    T* p;
+    size_t stride;
+    T& operator[](int j) const { return p[(size_t)j * stride]; }
+};
+
+// Reference to a member of object i in SoA storage: T& for scalars, ColumnRef<T> for arrays
+template <class T, int N>
+struct FieldRef
+{
+    using type = ColumnRef<T>;
+    static type make(T* col, size_t i, size_t n) { return ColumnRef<T>{ col + i, n }; }
+};
+template <class T>
+struct FieldRef<T, 1>
+{
+    using type = T&;
+    static type make(T* col, size_t i, size_t) { return col[i]; }
+};
+
+// Column size in bytes, rounded up to 64 so every column starts cache-line aligned
+template <class T, int N>
+constexpr size_t columnBytes(size_t n) { return (N * n * sizeof(T) + 63) / 64 * 64; }
+
+template <class S> struct Reflect;
+
+#define LAYOUT_MEMBER(T, NAME, N) typename FieldStorage<T, N>::type NAME;
+#define LAYOUT_REF(T, NAME, N) typename FieldRef<T, N>::type NAME;
+#define LAYOUT_COLUMN(T, NAME, N) T* NAME;
+#define LAYOUT_BYTES(T, NAME, N) + columnBytes<T, N>(n)
+#define LAYOUT_CARVE(T, NAME, N) c.NAME = (T*)buf; buf += columnBytes<T, N>(n);
+#define LAYOUT_BIND(T, NAME, N) FieldRef<T, N>::make(c.NAME, i, n),
+
+#define REFLECT_STRUCT(S, MEMBERS)                                                          \
+    struct S { MEMBERS(LAYOUT_MEMBER) };                                                    \
+    template <> struct Reflect<S>                                                           \
+    {                                                                                       \
+        struct Ref { MEMBERS(LAYOUT_REF) };                                                 \
+        struct Columns { MEMBERS(LAYOUT_COLUMN) };                                          \
+        static size_t bytes(size_t n) { return 0 MEMBERS(LAYOUT_BYTES); }                   \
+        static Columns carve(char* buf, size_t n) { Columns c; MEMBERS(LAYOUT_CARVE) return c; } \
+        static Ref ref(const Columns& c, size_t i, size_t n) { return Ref{ MEMBERS(LAYOUT_BIND) }; } \
+    };
+
+// The Basic struct of multiple_c_struct/struct_with_static_array, described once
+#define BASIC_MEMBERS(X) \
+    X(int, id, 1)        \
+    X(float, value, SIZE)
+
+REFLECT_STRUCT(Basic, BASIC_MEMBERS)
+
+/**
+ * @brief Array of structs: s[i] is a plain S&
+ *
+ * Both containers own a single buffer (host and device) and hand out trivially copyable
+ * views; kernels take the view by value, so s[i].member resolves on whichever side runs.
+ */
+template <class S>
+class AoS
+{
+    public:
+        struct View
+        {
+            S* p;
+            size_t n;
+            S& operator[](size_t i) const { return p[i]; }
+            size_t size() const { return n; }
+        };
+    private:
+        S* buf;
+        size_t n;
+    public:
+        explicit AoS(size_t count) : n(count) {
+            buf = (S*)calloc(n, sizeof(S));
+            #pragma acc enter data copyin(buf[0:n])
+        }
+        ~AoS() {
+            #pragma acc exit data delete(buf[0:n])
+            free(buf);
+        }
+        View host() const { return View{ buf, n }; }
+        View device() const {
+#ifndef NOACC
+            return View{ (S*)acc_deviceptr(buf), n };
+#else
+            return host();
+#endif
+        }
+        void toDevice() {
+            #pragma acc update device(buf[0:n])
+        }
+        void toHost() {
+            #pragma acc update self(buf[0:n])
+        }
+        size_t bytes() const { return n * sizeof(S); }
+};
+
+// Struct of arrays: s[i] is a proxy whose members are references into the columns
+template <class S>
+class SoA
+{
+    public:
+        using Columns = typename Reflect<S>::Columns;
+        struct View
+        {
+            Columns c;
+            size_t n;
+            typename Reflect<S>::Ref operator[](size_t i) const { return Reflect<S>::ref(c, i, n); }
+            size_t size() const { return n; }
+        };
+    private:
+        char* buf;
+        size_t n;
+        size_t nbytes;
+    public:
+        explicit SoA(size_t count) : n(count) {
+            nbytes = Reflect<S>::bytes(n);
+            buf = (char*)aligned_alloc(64, nbytes);
+            memset(buf, 0, nbytes);
+            #pragma acc enter data copyin(buf[0:nbytes])
+        }
+        ~SoA() {
+            #pragma acc exit data delete(buf[0:nbytes])
+            free(buf);
+        }
+        View host() const { return View{ Reflect<S>::carve(buf, n), n }; }
+        View device() const {
+#ifndef NOACC
+            return View{ Reflect<S>::carve((char*)acc_deviceptr(buf), n), n };
+#else
+            return host();
+#endif
+        }
+        void toDevice() {
+            #pragma acc update device(buf[0:nbytes])
+        }
+        void toHost() {
+            #pragma acc update self(buf[0:nbytes])
+        }
+        size_t bytes() const { return nbytes; }
+};
+
+static_assert(std::is_trivially_copyable_v<AoS<Basic>::View>);
+static_assert(std::is_trivially_copyable_v<SoA<Basic>::View>);
+
+// Kernels from aos_with_dynamic_arrays, written once against s[i].id and s[i].value[j]
+
+// Kernel 1: id = i + 1, value[j] = 2 + j + i
+template <class V>
+void initKernel(V s)
+{
+    const size_t n = s.size();
+    #pragma acc parallel loop gang vector firstprivate(s)
+    for (size_t i = 0; i < n; ++i) {
+        s[i].id = (int)i + 1;
+        #pragma acc loop seq
+        for (int j = 0; j < SIZE; ++j) {
+            s[i].value[j] = 2.0f + (float)j + (float)i;
+        }
+    }
+}
+
+// Kernel 2: id -= 1, value[j] *= 2 (touches every member)
+template <class V>
+void modifyKernel(V s)
+{
+    const size_t n = s.size();
+    #pragma acc parallel loop gang vector firstprivate(s)
+    for (size_t i = 0; i < n; ++i) {
+        s[i].id -= 1;
+        #pragma acc loop seq
+        for (int j = 0; j < SIZE; ++j) {
+            s[i].value[j] *= 2.0f;
+        }
+    }
+}
+
+// Kernel 3: only the value member is read (an AoS layout drags the id through the cache too)
+template <class V>
+double sumValuesKernel(V s)
+{
+    const size_t n = s.size();
+    double total = 0.0;
+    #pragma acc parallel loop gang vector firstprivate(s) reduction(+:total)
+    for (size_t i = 0; i < n; ++i) {
+        float acc = 0.0f;
+        #pragma acc loop seq
+        for (int j = 0; j < SIZE; ++j) {
+            acc += s[i].value[j];
+        }
+        total += acc;
+    }
+    return total;
+}
+
+// Kernel 4: only the value member is updated
+template <class V>
+void scaleValuesKernel(V s, float a)
+{
+    const size_t n = s.size();
+    #pragma acc parallel loop gang vector firstprivate(s)
+    for (size_t i = 0; i < n; ++i) {
+        #pragma acc loop seq
+        for (int j = 0; j < SIZE; ++j) {
+            s[i].value[j] = a * s[i].value[j] + 1.0f;
+        }
+    }
+}
+
+// Runs the kernels on one container type; the layout is the only difference
+template <class Container>
+void run(const char* name, size_t n, int nrep, Basic* out, double& checksum)
+{
+    Container c(n);
+    auto s = c.device();
+
+    PUSH_RANGE(name, 0);
+    initKernel(s);
+    modifyKernel(s);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < nrep; ++r) {
+        scaleValuesKernel(s, 0.5f);
+    }
+    const double tScale = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() / nrep;
+
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < nrep; ++r) {
+        checksum = sumValuesKernel(s);
+    }
+    const double tSum = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() / nrep;
+    POP_RANGE
+
+    // Scatter back to plain structs for the comparison, through the same accessor syntax
+    c.toHost();
+    auto h = c.host();
+    for (size_t i = 0; i < n; ++i) {
+        out[i].id = h[i].id;
+        for (int j = 0; j < SIZE; ++j) {
+            out[i].value[j] = h[i].value[j];
+        }
+    }
+
+    const double useful = (double)n * SIZE * sizeof(float);
+    printf("%-10s | %8.1f MB | scale %8.3f ms %7.2f GB/s | sum %8.3f ms %7.2f GB/s\n", name, c.bytes() / 1.0e6,
+           tScale * 1.0e3, 2.0 * useful / tScale * 1.0e-9, tSum * 1.0e3, useful / tSum * 1.0e-9);
+}
+
+// Switching the layout of the whole program is a one-line change
+using Layout = SoA<Basic>;
+
+int main(int argc, const char** argv)
+{
+    const size_t n = (argc > 1) ? (size_t)atol(argv[1]) : 4000000; // Number of Basic objects
+    const int nrep = (argc > 2) ? atoi(argv[2]) : 10;
+
+    printf("%zu Basic objects (SIZE = %d), sizeof(Basic) = %zu bytes\n", n, SIZE, sizeof(Basic));
+
+    // Small check with the aos_with_dynamic_arrays values, using the program-wide alias
+    {
+        Layout small(4);
+        auto s = small.device();
+        initKernel(s);
+        modifyKernel(s);
+        small.toHost();
+        auto h = small.host();
+        for (size_t i = 0; i < 4; ++i) {
+            printf("Basic[%zu].id = %d, value = [%f, %f, %f]\n", i, h[i].id, h[i].value[0], h[i].value[1], h[i].value[2]);
+        }
+    }
+
+    Basic* aos = (Basic*)malloc(n * sizeof(Basic));
+    Basic* soa = (Basic*)malloc(n * sizeof(Basic));
+    double sumAos = 0.0, sumSoa = 0.0;
+    run<AoS<Basic>>("AoS<Basic>", n, nrep, aos, sumAos);
+    run<SoA<Basic>>("SoA<Basic>", n, nrep, soa, sumSoa);
+
+    int mismatches = 0;
+    for (size_t i = 0; i < n; ++i) {
+        mismatches += (aos[i].id != soa[i].id);
+        for (int j = 0; j < SIZE; ++j) {
+            mismatches += (aos[i].value[j] != soa[i].value[j]);
+        }
+    }
+    printf("Mismatches between layouts: %d, checksums %.6e / %.6e\n", mismatches, sumAos, sumSoa);
+
+    free(aos);
+    free(soa);
+    return (mismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,398 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Non-owning mdspan-style views over line/point/component data with selectable layouts
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <type_traits>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Extents of the rank-3 [line][point][component] index space
+struct Extents3
+{
+    int nl; // Lines
+    int np; // Points per line
+    int nc; // Components (data entries) per point
+};
+
+/**
+ * @brief Layout policies in the spirit of std::mdspan (C++23, not available in GCC 12)
+ *
+ * Each policy provides a mapping from (l, p, c) to an offset. All mappings here are separable,
+ * i.e. map(l, p, c) = map(l, 0, 0) + map(0, p, 0) + map(0, 0, c), which is what allows fixing
+ * any index by shifting the data pointer (see View::line and View::component).
+ */
+
+// layout_right: component fastest, then point, then line (the contiguous Line/Point/data order)
+struct LayoutRight
+{
+    struct mapping
+    {
+        Extents3 ext;
+        size_t operator()(int l, int p, int c) const {
+            return ((size_t)l * ext.np + p) * ext.nc + c;
+        }
+        size_t required_span_size() const { return (size_t)ext.nl * ext.np * ext.nc; }
+        mapping withLines(int n) const { mapping m = *this; m.ext.nl = n; return m; }
+    };
+    static mapping make(Extents3 e) { return mapping{ e }; }
+};
+
+// layout_stride: arbitrary strides; make() builds the component-major (SoA) order
+struct LayoutStride
+{
+    struct mapping
+    {
+        Extents3 ext;
+        size_t stride[3];
+        size_t operator()(int l, int p, int c) const {
+            return (size_t)l * stride[0] + (size_t)p * stride[1] + (size_t)c * stride[2];
+        }
+        size_t required_span_size() const {
+            if (ext.nl == 0 || ext.np == 0 || ext.nc == 0) {
+                return 0;
+            }
+            return 1 + (size_t)(ext.nl - 1) * stride[0] + (size_t)(ext.np - 1) * stride[1] + (size_t)(ext.nc - 1) * stride[2];
+        }
+        mapping withLines(int n) const { mapping m = *this; m.ext.nl = n; return m; }
+    };
+    static mapping make(Extents3 e) {
+        return mapping{ e, { (size_t)e.np, 1, (size_t)e.nl * e.np } };
+    }
+};
+
+// AoSoA<V>: points of a line grouped in blocks of V lanes; inside a block each component is contiguous over the lanes
+template <int V>
+struct LayoutAoSoA
+{
+    struct mapping
+    {
+        Extents3 ext;
+        int nb; // Blocks per line
+        size_t operator()(int l, int p, int c) const {
+            return (((size_t)l * nb + p / V) * ext.nc + c) * V + p % V;
+        }
+        size_t required_span_size() const { return (size_t)ext.nl * nb * ext.nc * V; }
+        mapping withLines(int n) const { mapping m = *this; m.ext.nl = n; return m; }
+    };
+    static mapping make(Extents3 e) { return mapping{ e, (e.np + V - 1) / V }; }
+};
+
+// Rank-2 view obtained by fixing index AXIS of a rank-3 view (the fixed offset is already in the pointer)
+template <class T, class M, int AXIS>
+class View2
+{
+    private:
+        T* ptr;
+        M map;
+    public:
+        View2() = default;
+        View2(T* p, const M& m) : ptr(p), map(m) {}
+        T& operator()(int a, int b) const {
+            if constexpr (AXIS == 0) {
+                return ptr[map(0, a, b)];
+            } else if constexpr (AXIS == 1) {
+                return ptr[map(a, 0, b)];
+            } else {
+                return ptr[map(a, b, 0)];
+            }
+        }
+        int extent(int r) const {
+            const int e[3] = { map.ext.nl, map.ext.np, map.ext.nc };
+            return e[(r < AXIS) ? r : r + 1];
+        }
+};
+
+/**
+ * @brief Non-owning rank-3 view: a pointer and a layout mapping, nothing else
+ *
+ * Trivially copyable, so it is passed to kernels by value (firstprivate). Slicing returns a new
+ * view over the same memory; nothing is copied.
+ */
+template <class T, class Layout>
+class View
+{
+    public:
+        using mapping_type = typename Layout::mapping;
+    private:
+        T* ptr;
+        mapping_type map;
+    public:
+        View() = default;
+        View(T* p, const mapping_type& m) : ptr(p), map(m) {}
+        T& operator()(int l, int p, int c) const { return ptr[map(l, p, c)]; }
+        int extent(int r) const { return (r == 0) ? map.ext.nl : ((r == 1) ? map.ext.np : map.ext.nc); }
+        T* data() const { return ptr; }
+        const mapping_type& mapping() const { return map; }
+        // Same view over another copy of the data (e.g. its device counterpart)
+        View withData(T* p) const { return View(p, map); }
+        // Lines [first, first + count)
+        View sliceLines(int first, int count) const { return View(ptr + map(first, 0, 0), map.withLines(count)); }
+        // [point][component] of line l
+        View2<T, mapping_type, 0> line(int l) const { return View2<T, mapping_type, 0>(ptr + map(l, 0, 0), map); }
+        // [line][point] of component c
+        View2<T, mapping_type, 2> component(int c) const { return View2<T, mapping_type, 2>(ptr + map(0, 0, c), map); }
+};
+
+static_assert(std::is_trivially_copyable_v<View<float, LayoutRight>>);
+static_assert(std::is_trivially_copyable_v<View<float, LayoutStride>>);
+static_assert(std::is_trivially_copyable_v<View<float, LayoutAoSoA<8>>>);
+static_assert(std::is_trivially_copyable_v<View2<float, LayoutAoSoA<8>::mapping, 0>>);
+
+// Owning host/device buffer for a given layout; hands out host and device views
+template <class Layout>
+class Storage
+{
+    private:
+        float* buf;
+        size_t n;
+        View<float, Layout> hv;
+    public:
+        explicit Storage(Extents3 e) {
+            const typename Layout::mapping m = Layout::make(e);
+            n = m.required_span_size();
+            buf = (float*)calloc(n, sizeof(float));
+            #pragma acc enter data create(buf[0:n])
+            hv = View<float, Layout>(buf, m);
+        }
+        ~Storage() {
+            #pragma acc exit data delete(buf[0:n])
+            free(buf);
+        }
+        View<float, Layout> host() const { return hv; }
+        View<float, Layout> device() const {
+#ifndef NOACC
+            return hv.withData((float*)acc_deviceptr(buf));
+#else
+            return hv;
+#endif
+        }
+        void toDevice() {
+            #pragma acc update device(buf[0:n])
+        }
+        void toHost() {
+            #pragma acc update self(buf[0:n])
+        }
+        size_t span() const { return n; }
+};
+
+// Kernels are written once against the view; the layout is a template parameter only
+
+// v(l, p, c) = a * v(l, p, c) + (l + p + c)
+template <class V>
+void updateKernel(V v, float a)
+{
+    const int nl = v.extent(0), np = v.extent(1), nc = v.extent(2);
+    #pragma acc parallel loop gang vector collapse(2) firstprivate(v)
+    for (int l = 0; l < nl; ++l) {
+        for (int p = 0; p < np; ++p) {
+            #pragma acc loop seq
+            for (int c = 0; c < nc; ++c) {
+                v(l, p, c) = a * v(l, p, c) + (float)(l + p + c);
+            }
+        }
+    }
+}
+
+// Per-line sum of one component through a rank-2 line slice
+template <class V>
+void lineSumKernel(V v, int c, double* sums)
+{
+    const int nl = v.extent(0), np = v.extent(1);
+    #pragma acc parallel loop gang firstprivate(v) copyout(sums[0:nl])
+    for (int l = 0; l < nl; ++l) {
+        auto pts = v.line(l);
+        double s = 0.0;
+        #pragma acc loop vector reduction(+:s)
+        for (int p = 0; p < np; ++p) {
+            s += pts(p, c);
+        }
+        sums[l] = s;
+    }
+}
+
+// Initial value of entry (l, p, c)
+inline float initValue(int l, int p, int c)
+{
+    return (float)((l * 7 + p * 3 + c) % 17) * 0.25f;
+}
+
+// Runs both kernels on one layout; returns the update time per repetition
+template <class Layout>
+double runLayout(const char* name, Extents3 e, int nrep, float* ref, double* sums)
+{
+    Storage<Layout> st(e);
+    View<float, Layout> h = st.host();
+    for (int l = 0; l < e.nl; ++l) {
+        for (int p = 0; p < e.np; ++p) {
+            for (int c = 0; c < e.nc; ++c) {
+                h(l, p, c) = initValue(l, p, c);
+            }
+        }
+    }
+    st.toDevice();
+    View<float, Layout> d = st.device();
+
+    PUSH_RANGE(name, 0);
+    updateKernel(d, 0.5f); // Warm-up
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < nrep; ++r) {
+        updateKernel(d, 0.5f);
+    }
+#ifndef NOACC
+    #pragma acc wait
+#endif
+    const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() / nrep;
+    lineSumKernel(d.sliceLines(0, e.nl), 1, sums);
+    POP_RANGE
+
+    // Copy back in logical order, so all layouts can be compared entry by entry
+    st.toHost();
+    for (int l = 0; l < e.nl; ++l) {
+        for (int p = 0; p < e.np; ++p) {
+            for (int c = 0; c < e.nc; ++c) {
+                ref[((size_t)l * e.np + p) * e.nc + c] = h(l, p, c);
+            }
+        }
+    }
+
+    const double bytes = 2.0 * (double)e.nl * e.np * e.nc * sizeof(float);
+    printf("%-14s | span %10zu | %9.3f ms | %8.2f GB/s\n", name, st.span(), t * 1.0e3, bytes / t * 1.0e-9);
+    return t;
+}
+
+// Minimal Point/Line pair from array_of_objects whose data aliases a layout_right buffer
+class Point
+{
+    private:
+        int pID;
+        int dataSize;
+        float* pData;
+    public:
+        float* getData() const { return pData; }
+        void setPoint(int id, int n, float* storage) { pID = id; dataSize = n; pData = storage; }
+};
+
+class Line
+{
+    private:
+        int lID;
+        int nPoints;
+        Point* points;
+    public:
+        Point* getPoints() const { return points; }
+        void setLine(int id, int np, int ndata, float* storage) {
+            lID = id;
+            nPoints = np;
+            points = (Point*)calloc(np, sizeof(Point));
+            for (int i = 0; i < np; ++i) {
+                points[i].setPoint(id * np + i, ndata, storage + (size_t)i * ndata);
+            }
+        }
+        void freeLine() { free(points); }
+};
+
+int main(int argc, const char** argv)
+{
+    Extents3 e;
+    e.nl = (argc > 1) ? atoi(argv[1]) : 16384; // Lines
+    e.np = (argc > 2) ? atoi(argv[2]) : 64;    // Points per line
+    e.nc = (argc > 3) ? atoi(argv[3]) : 4;     // Components per point
+    const int nrep = (argc > 4) ? atoi(argv[4]) : 10;
+    const size_t n = (size_t)e.nl * e.np * e.nc;
+
+    printf("View over %d lines x %d points x %d components (%.1f MB)\n", e.nl, e.np, e.nc, n * sizeof(float) / 1.0e6);
+    printf("%-14s | %15s | %12s | %s\n", "layout", "", "update", "bandwidth");
+
+    float* ref[3];
+    double* sums[3];
+    for (int i = 0; i < 3; ++i) {
+        ref[i] = (float*)malloc(n * sizeof(float));
+        sums[i] = (double*)malloc(e.nl * sizeof(double));
+    }
+    runLayout<LayoutRight>("layout_right", e, nrep, ref[0], sums[0]);
+    runLayout<LayoutStride>("layout_stride", e, nrep, ref[1], sums[1]);
+    runLayout<LayoutAoSoA<8>>("aosoa<8>", e, nrep, ref[2], sums[2]);
+
+    // Same kernels, same results, independent of the layout
+    double diff = 0.0;
+    for (int i = 1; i < 3; ++i) {
+        for (size_t k = 0; k < n; ++k) {
+            diff = std::max(diff, (double)std::fabs(ref[i][k] - ref[0][k]));
+        }
+        for (int l = 0; l < e.nl; ++l) {
+            diff = std::max(diff, std::fabs(sums[i][l] - sums[0][l]));
+        }
+    }
+    printf("Max difference between layouts: %.1e\n", diff);
+
+    // The Line/Point chain and the layout_right view read the same memory without copying any object
+    Line* lines = (Line*)calloc(e.nl, sizeof(Line));
+    for (int l = 0; l < e.nl; ++l) {
+        lines[l].setLine(l, e.np, e.nc, ref[0] + (size_t)l * e.np * e.nc);
+    }
+    View<float, LayoutRight> v(ref[0], LayoutRight::make(e));
+    auto comp = v.component(e.nc - 1);
+    int mismatches = 0;
+    for (int l = 0; l < e.nl; ++l) {
+        for (int p = 0; p < e.np; ++p) {
+            const float* chain = lines[l].getPoints()[p].getData();
+            mismatches += (&chain[0] != &v(l, p, 0)) || (&chain[e.nc - 1] != &comp(l, p));
+        }
+        lines[l].freeLine();
+    }
+    printf("Line/Point chain vs view aliasing mismatches: %d\n", mismatches);
+    free(lines);
+
+    for (int i = 0; i < 3; ++i) {
+        free(ref[i]);
+        free(sums[i]);
+    }
+    return (diff == 0.0 && mismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,488 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Tagged allocators reporting memory footprint per class and per phase (host and device)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <iostream>
+#include <new>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <malloc.h>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Classes whose memory is accounted separately
+enum MemTag { TAG_POINT = 0, TAG_GAUSSPOINT, TAG_LINE, TAG_BASIC, NUM_TAGS };
+const char* tagNames[NUM_TAGS] = { "Point", "GaussPoint", "Line", "Basic" };
+
+// Memory spaces: host heap and (emulated) device memory
+enum MemSpace { SPACE_HOST = 0, SPACE_DEVICE, NUM_SPACES };
+const char* spaceNames[NUM_SPACES] = { "host", "device" };
+
+// Device allocations are modelled as rounded up to this granularity (as cudaMalloc does)
+#define DEVICE_GRANULARITY 256
+// Bytes per entry of the OpenACC present table, charged to the device as overhead
+#define DEVICE_MAP_ENTRY 64
+// glibc chunk header preceding every malloc'd block
+#define HOST_CHUNK_HEADER 8
+
+// Counters of one (space, class) or (space, phase) pair
+struct MemStats
+{
+    long live;       // Bytes currently allocated (as requested)
+    long peak;       // Maximum of live
+    long allocs;     // Number of allocations
+    long frees;      // Number of frees
+    long overhead;   // Allocator overhead: headers, rounding, mapping entries
+    long padding;    // Struct padding inside the allocated objects
+};
+
+// Information kept for each live tracked block
+struct BlockInfo
+{
+    long bytes;    // Requested size
+    long overhead; // Allocator overhead charged for it
+    long padding;  // Padding inside it
+    int tag;       // Owning class
+    int phase;     // Phase that allocated it
+};
+
+// Accounting layer: every tracked allocation is recorded per class and per phase
+class MemAccounting
+{
+    private:
+        std::mutex mtx;
+        MemStats perTag[NUM_SPACES][NUM_TAGS];     // Per class
+        std::vector<std::string> phaseNames;       // Phases in order of first use
+        std::vector<MemStats> perPhase[NUM_SPACES]; // Per phase
+        long total[NUM_SPACES];                    // Live bytes over all classes
+        std::vector<int> phaseStack;               // Open phases
+        std::unordered_map<const void*, BlockInfo> blocks[NUM_SPACES]; // Live blocks
+
+        void addPhase(const char* name) {
+            phaseNames.push_back(name);
+            for (int s = 0; s < NUM_SPACES; ++s) {
+                perPhase[s].push_back(MemStats{0, 0, 0, 0, 0, 0});
+            }
+        }
+
+        int currentPhase() const { return phaseStack.empty() ? 0 : phaseStack.back(); }
+    public:
+        MemAccounting() {
+            memset(perTag, 0, sizeof(perTag));
+            total[SPACE_HOST] = 0;
+            total[SPACE_DEVICE] = 0;
+            addPhase("(none)");
+        }
+
+        void pushPhase(const char* name) {
+            std::lock_guard<std::mutex> lock(mtx);
+            int idx = -1;
+            for (size_t p = 0; p < phaseNames.size(); ++p) {
+                if (phaseNames[p] == name) {
+                    idx = (int)p;
+                }
+            }
+            if (idx < 0) {
+                addPhase(name);
+                idx = (int)phaseNames.size() - 1;
+            }
+            phaseStack.push_back(idx);
+            // The phase peak starts from what is already live
+            for (int s = 0; s < NUM_SPACES; ++s) {
+                perPhase[s][idx].peak = std::max(perPhase[s][idx].peak, total[s]);
+            }
+        }
+
+        void popPhase() {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!phaseStack.empty()) {
+                phaseStack.pop_back();
+            }
+        }
+
+        void recordAlloc(int space, const void* ptr, int tag, long bytes, long overhead, long padding) {
+            std::lock_guard<std::mutex> lock(mtx);
+            const int ph = currentPhase();
+            blocks[space][ptr] = BlockInfo{bytes, overhead, padding, tag, ph};
+            total[space] += bytes;
+            MemStats* stats[2] = { &perTag[space][tag], &perPhase[space][ph] };
+            for (MemStats* s : stats) {
+                s->allocs += 1;
+                s->live += bytes;
+                s->overhead += overhead;
+                s->padding += padding;
+            }
+            perTag[space][tag].peak = std::max(perTag[space][tag].peak, perTag[space][tag].live);
+            perPhase[space][ph].peak = std::max(perPhase[space][ph].peak, total[space]);
+        }
+
+        void recordFree(int space, const void* ptr) {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = blocks[space].find(ptr);
+            if (it == blocks[space].end()) {
+                return;
+            }
+            const BlockInfo b = it->second;
+            blocks[space].erase(it);
+            total[space] -= b.bytes;
+            perTag[space][b.tag].live -= b.bytes;
+            perTag[space][b.tag].frees += 1;
+            perTag[space][b.tag].overhead -= b.overhead;
+            perTag[space][b.tag].padding -= b.padding;
+            // Phases report what they allocated; frees are charged to the phase that runs them
+            perPhase[space][currentPhase()].frees += 1;
+            perPhase[space][b.phase].live -= b.bytes;
+        }
+
+        void report() {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (int s = 0; s < NUM_SPACES; ++s) {
+                printf("\n[%s] per class\n", spaceNames[s]);
+                printf("%-12s %12s %12s %8s %8s %12s %12s\n",
+                       "Class", "Live[B]", "Peak[B]", "Allocs", "Frees", "Overhead[B]", "Padding[B]");
+                for (int t = 0; t < NUM_TAGS; ++t) {
+                    const MemStats& m = perTag[s][t];
+                    printf("%-12s %12ld %12ld %8ld %8ld %12ld %12ld\n",
+                           tagNames[t], m.live, m.peak, m.allocs, m.frees, m.overhead, m.padding);
+                }
+                printf("[%s] per phase (live = still allocated from this phase, peak = total live during it)\n", spaceNames[s]);
+                printf("%-24s %12s %12s %8s %8s %12s %12s\n",
+                       "Phase", "Live[B]", "Peak[B]", "Allocs", "Frees", "Overhead[B]", "Padding[B]");
+                for (size_t p = 0; p < phaseNames.size(); ++p) {
+                    const MemStats& m = perPhase[s][p];
+                    if (m.allocs == 0 && m.frees == 0) {
+                        continue;
+                    }
+                    printf("%-24s %12ld %12ld %8ld %8ld %12ld %12ld\n",
+                           phaseNames[p].c_str(), m.live, m.peak, m.allocs, m.frees, m.overhead, m.padding);
+                }
+            }
+        }
+};
+
+MemAccounting memAcc;
+
+// Tagged host calloc: overhead is what the allocator really reserved beyond the request
+void* tagged_calloc(int tag, size_t n, size_t size, size_t padding = 0)
+{
+    void* p = calloc(n, size);
+    if (p) {
+        const long bytes = (long)(n * size);
+        const long overhead = (long)malloc_usable_size(p) - bytes + HOST_CHUNK_HEADER;
+        memAcc.recordAlloc(SPACE_HOST, p, tag, bytes, overhead, (long)padding);
+    }
+    return p;
+}
+
+void tagged_free(void* p)
+{
+    if (p) {
+        memAcc.recordFree(SPACE_HOST, p);
+        free(p);
+    }
+}
+
+// Device-side accounting, called next to every acc enter/exit data directive
+void device_enter(int tag, const void* hostPtr, size_t bytes, size_t padding = 0)
+{
+    const long rounded = (long)((bytes + DEVICE_GRANULARITY - 1) / DEVICE_GRANULARITY) * DEVICE_GRANULARITY;
+    memAcc.recordAlloc(SPACE_DEVICE, hostPtr, tag, (long)bytes, rounded - (long)bytes + DEVICE_MAP_ENTRY, (long)padding);
+}
+
+void device_exit(const void* hostPtr)
+{
+    memAcc.recordFree(SPACE_DEVICE, hostPtr);
+}
+
+// Class-level operator new/delete routing array allocations through the tagged allocator.
+// Padding is sizeof(T) minus the sum of its member sizes, per object.
+#define TAGGED_NEW_DELETE(T, TAG) \
+    static void* operator new[](size_t bytes) { \
+        size_t count = bytes / sizeof(T); \
+        void* p = tagged_calloc(TAG, 1, bytes, count * (sizeof(T) - T::memberBytes())); \
+        if (!p) throw std::bad_alloc(); \
+        return p; \
+    } \
+    static void operator delete[](void* p) { tagged_free(p); } \
+    static void* operator new(size_t bytes) { \
+        void* p = tagged_calloc(TAG, 1, bytes, sizeof(T) - T::memberBytes()); \
+        if (!p) throw std::bad_alloc(); \
+        return p; \
+    } \
+    static void operator delete(void* p) { tagged_free(p); }
+
+// Phase markers
+#define PUSH_PHASE(name) memAcc.pushPhase(name);
+#define POP_PHASE memAcc.popPhase();
+
+// Parent Point class (from self_instantiation_adv)
+class Point
+{
+    protected:
+        int pID;      // Point ID
+        int dataSize; // Data field size
+        float* xyz;   // Coordinates in 3D
+        float* data;  // Data field array
+    public:
+        static size_t memberBytes() { return 2 * sizeof(int) + 2 * sizeof(float*); }
+        TAGGED_NEW_DELETE(Point, TAG_POINT)
+
+        Point() {
+            pID = -1;
+            dataSize = -1;
+            xyz = nullptr;
+            data = nullptr;
+        }
+
+        ~Point() {
+            release();
+        }
+
+        // The tag lets derived classes charge the inherited arrays to themselves
+        // (no virtual function: the object must stay vtable-free for the device)
+        void setPoint(int id, int size, int tag = TAG_POINT) {
+            this->pID = id;
+            this->dataSize = size;
+            xyz = (float *)tagged_calloc(tag, 3, sizeof(float));
+            data = (float *)tagged_calloc(tag, size, sizeof(float));
+            PUSH_RANGE("Point::setPoint", 0);
+            #pragma acc enter data copyin(this)
+            #pragma acc enter data copyin(xyz[0:3])
+            #pragma acc enter data copyin(data[0:dataSize])
+            POP_RANGE
+            device_enter(tag, xyz, 3 * sizeof(float));
+            device_enter(tag, data, dataSize * sizeof(float));
+        }
+
+        void release() {
+            if (data) {
+                #pragma acc exit data delete(data[0:dataSize])
+                #pragma acc exit data delete(xyz[0:3])
+                device_exit(data);
+                device_exit(xyz);
+                tagged_free(data);
+                tagged_free(xyz);
+                data = nullptr;
+                xyz = nullptr;
+            }
+        }
+
+        void setPointDataEntry(int idx, float value) {
+            data[idx] = value;
+        }
+};
+
+// Child GaussPoint class, derived from Point
+class GaussPoint : public Point
+{
+    private:
+        float gpWeight;
+    public:
+        static size_t memberBytes() { return Point::memberBytes() + sizeof(float); }
+        TAGGED_NEW_DELETE(GaussPoint, TAG_GAUSSPOINT)
+
+        GaussPoint() : Point(), gpWeight(0.0f) {}
+
+        void setGaussPoint(int id, int size, float weight) {
+            this->setPoint(id, size, TAG_GAUSSPOINT);
+            gpWeight = weight;
+        }
+};
+
+// Line class that uses an array of Points and an array of GaussPoints
+class Line
+{
+    private:
+        int lineID;
+        int numPoints;
+        int numGaussPoints;
+        Point *points;
+        GaussPoint *gaussPoints;
+    public:
+        static size_t memberBytes() { return 3 * sizeof(int) + sizeof(Point*) + sizeof(GaussPoint*); }
+        TAGGED_NEW_DELETE(Line, TAG_LINE)
+
+        Line() {
+            lineID = -1;
+            numPoints = -1;
+            numGaussPoints = -1;
+            points = nullptr;
+            gaussPoints = nullptr;
+        }
+
+        ~Line() {
+            if (points) {
+                #pragma acc exit data delete(points[0:numPoints])
+                #pragma acc exit data delete(gaussPoints[0:numGaussPoints])
+                device_exit(points);
+                device_exit(gaussPoints);
+                delete[] points;
+                delete[] gaussPoints;
+                points = nullptr;
+                gaussPoints = nullptr;
+            }
+        }
+
+        void setLine(int id, int np, int ngp, int ndata) {
+            lineID = id;
+            numPoints = np;
+            numGaussPoints = ngp;
+
+            points = new Point[numPoints];
+            #pragma acc enter data create(points[0 : numPoints])
+            device_enter(TAG_POINT, points, numPoints * sizeof(Point), numPoints * (sizeof(Point) - Point::memberBytes()));
+
+            gaussPoints = new GaussPoint[numGaussPoints];
+            #pragma acc enter data create(gaussPoints[0 : numGaussPoints])
+            device_enter(TAG_GAUSSPOINT, gaussPoints, numGaussPoints * sizeof(GaussPoint),
+                         numGaussPoints * (sizeof(GaussPoint) - GaussPoint::memberBytes()));
+
+            for (int i = 0; i < numPoints; ++i) {
+                points[i].setPoint(lineID * numPoints + i, ndata);
+            }
+            for (int i = 0; i < numGaussPoints; ++i) {
+                gaussPoints[i].setGaussPoint(i, ndata, 1.0f);
+            }
+        }
+
+        void modifyPointDataEntry(int pointIndex, int dataIdx, float value) {
+            points[pointIndex].setPointDataEntry(dataIdx, value);
+        }
+};
+
+// Basic class (from self_instantiation)
+class Basic
+{
+    private:
+        int arrSize; // No. elements in data pointer
+        float* data; // Data pointer
+    public:
+        static size_t memberBytes() { return sizeof(int) + sizeof(float*); }
+        TAGGED_NEW_DELETE(Basic, TAG_BASIC)
+
+        Basic(int size) {
+            arrSize = size;
+            data = (float*)tagged_calloc(TAG_BASIC, arrSize, sizeof(float));
+            #pragma acc enter data copyin(this[0:1])
+            #pragma acc enter data copyin(data[0:arrSize])
+            device_enter(TAG_BASIC, this, sizeof(Basic), sizeof(Basic) - memberBytes());
+            device_enter(TAG_BASIC, data, arrSize * sizeof(float));
+        }
+
+        ~Basic() {
+            if (data) {
+                #pragma acc exit data delete(data[0:arrSize])
+                device_exit(data);
+                tagged_free(data);
+                data = nullptr;
+            }
+            #pragma acc exit data delete(this[0:1])
+            device_exit(this);
+        }
+
+        int getSize() const { return arrSize; }
+        void setDataEntry(int index, float value) { data[index] = value; }
+};
+
+int main(int argc, const char** argv)
+{
+    const int nlines = (argc > 1) ? atoi(argv[1]) : 1000; // Number of lines
+    const int np = 3;     // Points per line (as in self_instantiation_adv)
+    const int ngp = 2;    // Gauss points per line
+    const int ndata = 5;  // Data entries per point
+
+    printf("sizeof: Point %zu (members %zu), GaussPoint %zu (members %zu), Line %zu (members %zu), Basic %zu (members %zu)\n",
+           sizeof(Point), Point::memberBytes(), sizeof(GaussPoint), GaussPoint::memberBytes(),
+           sizeof(Line), Line::memberBytes(), sizeof(Basic), Basic::memberBytes());
+
+    PUSH_PHASE("construct_lines");
+    Line* lines = new Line[nlines];
+    #pragma acc enter data create(lines[0:nlines])
+    device_enter(TAG_LINE, lines, nlines * sizeof(Line), nlines * (sizeof(Line) - Line::memberBytes()));
+    for (int i = 0; i < nlines; ++i) {
+        lines[i].setLine(i, np, ngp, ndata);
+    }
+    POP_PHASE
+
+    PUSH_PHASE("construct_basic");
+    Basic* obj = new Basic(1 << 16);
+    POP_PHASE
+
+    PUSH_PHASE("kernels");
+    #pragma acc parallel loop gang present(lines[0:nlines])
+    for (int iline = 0; iline < nlines; ++iline) {
+        #pragma acc loop vector
+        for (int i = 0; i < np; ++i) {
+            lines[iline].modifyPointDataEntry(i, 0, static_cast<float>(i * 1.5));
+        }
+    }
+    #pragma acc parallel loop present(obj[0:1])
+    for (int i = 0; i < obj->getSize(); i++) {
+        obj->setDataEntry(i, static_cast<float>(i+1));
+    }
+    POP_PHASE
+
+    // Snapshot while everything is alive
+    printf("\n=== Footprint with all objects alive ===");
+    memAcc.report();
+
+    PUSH_PHASE("destroy");
+    delete obj;
+    #pragma acc exit data delete(lines[0:nlines])
+    device_exit(lines);
+    delete[] lines;
+    POP_PHASE
+
+    printf("\n=== Footprint after destruction ===");
+    memAcc.report();
+
+    return 0;
+}
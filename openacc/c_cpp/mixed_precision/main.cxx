@@ -0,0 +1,356 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Point/Basic payloads stored in fp16/bf16 with fp32 compute
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Bit-level reinterpretation between float and uint32_t (host/device callable)
+inline uint32_t floatBits(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float bitsFloat(uint32_t u)
+{
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// IEEE 754 binary16 storage, converted in software (round to nearest even).
+// Both conversions use selects instead of branches, so that the calling loops can be vectorized; whether
+// they are depends on the compiler (check -Minfo/-fopt-info). Without hardware conversions the fp16 path
+// is compute-bound on the host and runs slower than fp32.
+struct Half
+{
+    uint16_t bits;
+
+    static Half fromFloat(float f) {
+        const uint32_t f32infty = 255u << 23;
+        const uint32_t f16max = (127u + 16u) << 23;
+        const uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+        uint32_t x = floatBits(f);
+        const uint32_t sign = x & 0x80000000u;
+        x ^= sign;
+        // Overflow to Inf, NaN stays NaN
+        const uint32_t special = (x > f32infty) ? 0x7e00u : 0x7c00u;
+        // Subnormal or zero: let the FPU round by adding a magic number
+        const uint32_t sub = floatBits(bitsFloat(x) + bitsFloat(denormMagic)) - denormMagic;
+        // Normal: rebias the exponent and round the mantissa to nearest even
+        const uint32_t norm = (x + ((uint32_t)(15 - 127) << 23) + 0xfffu + ((x >> 13) & 1u)) >> 13;
+        const uint32_t o = (x >= f16max) ? special : ((x < (113u << 23)) ? sub : norm);
+        Half h;
+        h.bits = (uint16_t)(o | (sign >> 16));
+        return h;
+    }
+
+    float toFloat() const {
+        const uint32_t shifted = (uint32_t)(bits & 0x7fffu) << 13; // Exponent/mantissa in place
+        const uint32_t exp = shifted & (0x7c00u << 13);
+        const uint32_t sign = (uint32_t)(bits & 0x8000u) << 16;
+        // Normal numbers only need the exponent rebias
+        const uint32_t normal = shifted + ((127u - 15u) << 23);
+        // Inf/NaN: push the exponent to all ones
+        const uint32_t special = normal + ((128u - 16u) << 23);
+        // Zero/subnormal: renormalize with a float subtraction
+        const uint32_t sub = floatBits(bitsFloat(normal + (1u << 23)) - bitsFloat(113u << 23));
+        const uint32_t o = (exp == (0x7c00u << 13)) ? special : ((exp == 0) ? sub : normal);
+        return bitsFloat(o | sign);
+    }
+};
+
+// bfloat16 storage: the upper half of a float, rounded to nearest even
+struct BFloat16
+{
+    uint16_t bits;
+
+    static BFloat16 fromFloat(float f) {
+        const uint32_t x = floatBits(f);
+        BFloat16 b;
+        if ((x & 0x7fffffffu) > 0x7f800000u) {
+            b.bits = (uint16_t)((x >> 16) | 0x40u); // Quiet NaN
+        } else {
+            b.bits = (uint16_t)((x + 0x7fffu + ((x >> 16) & 1u)) >> 16);
+        }
+        return b;
+    }
+
+    float toFloat() const {
+        return bitsFloat((uint32_t)bits << 16);
+    }
+};
+
+// Load/store conversions between a storage type and the compute type
+template <class Storage, class Compute>
+struct Precision
+{
+    static Compute load(Storage s) { return (Compute)s.toFloat(); }
+    static Storage store(Compute c) { return Storage::fromFloat((float)c); }
+    static const char* name();
+};
+
+// fp32 storage needs no conversion
+template <class Compute>
+struct Precision<float, Compute>
+{
+    static Compute load(float s) { return (Compute)s; }
+    static float store(Compute c) { return (float)c; }
+    static const char* name() { return "fp32"; }
+};
+
+template <> const char* Precision<Half, float>::name() { return "fp16"; }
+template <> const char* Precision<BFloat16, float>::name() { return "bf16"; }
+
+// Point with a payload stored as Storage and operated on as Compute
+template <class Storage, class Compute = float>
+class Point
+{
+    private:
+        int pID;        // Unique identifier for the Point
+        int dataSize;   // Size of the data array in elements
+        Storage* pData; // Payload in storage precision
+    public:
+        typedef Precision<Storage, Compute> P;
+
+        int getDataSize() const { return dataSize; }
+        Storage* getData() const { return pData; }
+
+        // Converting accessors (host/device callable)
+        Compute get(int k) const { return P::load(pData[k]); }
+        void set(int k, Compute v) { pData[k] = P::store(v); }
+
+        void setPoint(int id, int n) {
+            this->pID = id;
+            this->dataSize = n;
+            this->pData = (Storage*)calloc(n, sizeof(Storage));
+            #pragma acc enter data copyin(pData[0:dataSize])
+        }
+};
+
+// Line class contains an array of Point objects
+template <class Storage, class Compute = float>
+class Line
+{
+    private:
+        int lID;                         // Unique identifier for the Line
+        int nPoints;                     // Number of Point objects in this Line
+        Point<Storage, Compute>* points; // Pointer to an array of Point objects
+    public:
+        Point<Storage, Compute>* getPoints() const { return points; }
+        void setLine(int id, int np, int ndata) {
+            this->lID = id;
+            this->nPoints = np;
+            this->points = (Point<Storage, Compute>*)calloc(np, sizeof(Point<Storage, Compute>));
+            #pragma acc enter data copyin(points[0:nPoints])
+            for (int i = 0; i < np; ++i) {
+                points[i].setPoint(lID * np + i, ndata);
+            }
+        }
+};
+
+// Basic struct with a dynamic value array in storage precision
+template <class Storage>
+struct Basic
+{
+    int id;
+    Storage* value = nullptr;
+};
+
+// Results of one precision run
+struct RunResult
+{
+    double seconds;   // Time of all updates
+    double bytes;     // Payload bytes moved by all updates
+    double footprint; // Payload bytes resident
+    float* values;    // Final values as float, for the error check
+};
+
+// Update kernels (array_of_objects kernel_1 + kernel_2 shape, fused): load, compute in Compute, store
+template <class Storage, class Compute>
+RunResult runLines(int nlines, int np, int ndata, int nrep)
+{
+    typedef Point<Storage, Compute> PointT;
+    Line<Storage, Compute>* lines = (Line<Storage, Compute>*)calloc(nlines, sizeof(Line<Storage, Compute>));
+    #pragma acc enter data copyin(lines[0:nlines])
+    for (int i = 0; i < nlines; ++i) {
+        lines[i].setLine(i, np, ndata);
+    }
+
+    PUSH_RANGE((Precision<Storage, Compute>::name()), 0);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < nrep; ++r) {
+        #pragma acc parallel loop gang present(lines[0:nlines])
+        for (int i = 0; i < nlines; ++i) {
+            PointT* points = lines[i].getPoints();
+            #pragma acc loop vector
+            for (int j = 0; j < np; ++j) {
+                PointT& p = points[j];
+                #pragma acc loop seq
+                for (int k = 0; k < ndata; ++k) {
+                    const Compute d = p.get(k);
+                    p.set(k, (Compute)0.9 * d + (Compute)1e-3 * (Compute)(i + j + k) + (Compute)1);
+                }
+            }
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    POP_RANGE
+
+    RunResult res;
+    res.seconds = std::chrono::duration<double>(t1 - t0).count();
+    res.footprint = (double)nlines * np * ndata * sizeof(Storage);
+    res.bytes = 2.0 * res.footprint * nrep;
+    res.values = (float*)malloc((size_t)nlines * np * ndata * sizeof(float));
+    for (int i = 0; i < nlines; ++i) {
+        for (int j = 0; j < np; ++j) {
+            [[maybe_unused]] Storage* data = lines[i].getPoints()[j].getData(); // Only used by the update
+            #pragma acc update self(data[0:ndata])
+            for (int k = 0; k < ndata; ++k) {
+                res.values[((size_t)i * np + j) * ndata + k] = (float)lines[i].getPoints()[j].get(k);
+            }
+        }
+    }
+    return res;
+}
+
+// aos_with_dynamic_arrays kernels with Basic payloads in storage precision
+template <class Storage, class Compute>
+RunResult runBasics(int nobj, int size, int nrep)
+{
+    typedef Precision<Storage, Compute> P;
+    Basic<Storage>* objs = (Basic<Storage>*)malloc(nobj * sizeof(Basic<Storage>));
+    for (int i = 0; i < nobj; ++i) {
+        objs[i].id = i;
+        objs[i].value = (Storage*)calloc(size, sizeof(Storage));
+    }
+    #pragma acc enter data copyin(objs[0:nobj])
+    for (int i = 0; i < nobj; ++i) {
+        #pragma acc enter data copyin(objs[i].value[0:size])
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < nrep; ++r) {
+        #pragma acc parallel loop gang present(objs[0:nobj])
+        for (int i = 0; i < nobj; ++i) {
+            Storage* value = objs[i].value;
+            #pragma acc loop vector
+            for (int j = 0; j < size; ++j) {
+                const Compute v = P::load(value[j]);
+                value[j] = P::store((Compute)0.5 * v + (Compute)2 + (Compute)1e-3 * (Compute)(i + j));
+            }
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    RunResult res;
+    res.seconds = std::chrono::duration<double>(t1 - t0).count();
+    res.footprint = (double)nobj * size * sizeof(Storage);
+    res.bytes = 2.0 * res.footprint * nrep;
+    res.values = (float*)malloc((size_t)nobj * size * sizeof(float));
+    for (int i = 0; i < nobj; ++i) {
+        Storage* value = objs[i].value;
+        #pragma acc update self(value[0:size])
+        for (int j = 0; j < size; ++j) {
+            res.values[(size_t)i * size + j] = (float)P::load(value[j]);
+        }
+    }
+    return res;
+}
+
+// Print one row of the comparison table against the fp32 reference
+void report(const char* name, const RunResult& r, const RunResult& ref, size_t n)
+{
+    double maxAbs = 0.0, maxRel = 0.0;
+    for (size_t e = 0; e < n; ++e) {
+        const double d = fabs((double)r.values[e] - (double)ref.values[e]);
+        maxAbs = fmax(maxAbs, d);
+        maxRel = fmax(maxRel, d / fmax(fabs((double)ref.values[e]), 1e-30));
+    }
+    printf("  %-5s footprint %9.2f MB (%.2fx), %8.3f ms, %8.2f GB/s, speedup %.2fx, max abs err %.3e, max rel err %.3e\n",
+           name, r.footprint * 1e-6, ref.footprint / r.footprint, 1e3 * r.seconds, r.bytes / r.seconds * 1e-9,
+           ref.seconds / r.seconds, maxAbs, maxRel);
+}
+
+int main(int argc, const char** argv)
+{
+    const int nlines = (argc > 1) ? atoi(argv[1]) : 2048; // Number of lines
+    const int np = 64;                                    // Points per line
+    const int ndata = 64;                                 // Data entries per point
+    const int nobj = 2048;                                // Number of Basic structs
+    const int size = 8192;                                // Entries per Basic value array
+    const int nrep = 10;                                  // Update repetitions
+
+    // Conversion sanity checks
+    printf("fp16(1/3) = %.8f, bf16(1/3) = %.8f, fp16(65504) = %.1f, fp16(1e5) = %f, fp16(1e-7) = %.4e\n",
+           Half::fromFloat(1.0f / 3.0f).toFloat(), BFloat16::fromFloat(1.0f / 3.0f).toFloat(),
+           Half::fromFloat(65504.0f).toFloat(), Half::fromFloat(1e5f).toFloat(), Half::fromFloat(1e-7f).toFloat());
+
+    printf("Array of objects: %d lines x %d points x %d entries, %d updates\n", nlines, np, ndata, nrep);
+    RunResult l32 = runLines<float, float>(nlines, np, ndata, nrep);
+    RunResult l16 = runLines<Half, float>(nlines, np, ndata, nrep);
+    RunResult lbf = runLines<BFloat16, float>(nlines, np, ndata, nrep);
+    const size_t nl = (size_t)nlines * np * ndata;
+    report("fp32", l32, l32, nl);
+    report("fp16", l16, l32, nl);
+    report("bf16", lbf, l32, nl);
+
+    printf("AoS with dynamic arrays: %d objects x %d entries, %d updates\n", nobj, size, nrep);
+    RunResult b32 = runBasics<float, float>(nobj, size, nrep);
+    RunResult b16 = runBasics<Half, float>(nobj, size, nrep);
+    RunResult bbf = runBasics<BFloat16, float>(nobj, size, nrep);
+    const size_t nb = (size_t)nobj * size;
+    report("fp32", b32, b32, nb);
+    report("fp16", b16, b32, nb);
+    report("bf16", bbf, b32, nb);
+
+    return 0;
+}
@@ -0,0 +1,489 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Dynamic load balancing by migrating Lines and their Points/GaussPoints between MPI ranks
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// MPI headers
+#include <mpi.h>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Payload entries per Point and per GaussPoint
+const int NDATA = 5;
+
+// Point: its payload is NDATA floats at the same index in the store's point data pool
+class Point
+{
+    private:
+        int pID; // Global point ID
+    public:
+        int getId() const { return pID; }
+        void setPoint(int id) { pID = id; }
+};
+
+// GaussPoint: weight plus a payload in the store's Gauss data pool
+class GaussPoint
+{
+    private:
+        int gpID;       // Global Gauss point ID
+        float gpWeight; // Quadrature weight
+    public:
+        int getId() const { return gpID; }
+        float getWeight() const { return gpWeight; }
+        void setGaussPoint(int id, float w) {
+            gpID = id;
+            gpWeight = w;
+        }
+};
+
+// Line: owns ranges of the store's pools (offsets instead of pointers, so rebuilding never reallocates per object)
+class Line
+{
+    private:
+        int lID;         // Global line ID
+        int nPoints;     // Number of Points
+        int nGauss;      // Number of GaussPoints
+        long pointBegin; // First Point in the point pool
+        long gaussBegin; // First GaussPoint in the Gauss pool
+        float x, y;      // Centroid, for the space-filling curve
+    public:
+        int getId() const { return lID; }
+        int getNPoints() const { return nPoints; }
+        int getNGauss() const { return nGauss; }
+        long getPointBegin() const { return pointBegin; }
+        long getGaussBegin() const { return gaussBegin; }
+        float getX() const { return x; }
+        float getY() const { return y; }
+        void setLine(int id, int np, int ngp, long pb, long gb, float xc, float yc) {
+            lID = id;
+            nPoints = np;
+            nGauss = ngp;
+            pointBegin = pb;
+            gaussBegin = gb;
+            x = xc;
+            y = yc;
+        }
+};
+
+// Serialized form of a Line header; Points, GaussPoints and both payloads follow it in the buffer
+struct LineRecord
+{
+    int lID, nPoints, nGauss;
+    float x, y;
+};
+
+/**
+ * @brief All Lines of a rank with their Points, GaussPoints and payloads in contiguous pools
+ *
+ * Pools only grow: rebuilding after a migration reuses their capacity, so there is no
+ * allocation per object. Two stores are swapped at each migration.
+ */
+struct LineStore
+{
+    std::vector<Line> lines;
+    std::vector<Point> points;
+    std::vector<GaussPoint> gauss;
+    std::vector<float> pointData;
+    std::vector<float> gaussData;
+
+    void clear() {
+        lines.clear();
+        points.clear();
+        gauss.clear();
+        pointData.clear();
+        gaussData.clear();
+    }
+
+    // Appends a Line; returns pointers to its freshly reserved Points/GaussPoints/payloads
+    Line& append(const LineRecord& r) {
+        const long pb = (long)points.size(), gb = (long)gauss.size();
+        points.resize(pb + r.nPoints);
+        gauss.resize(gb + r.nGauss);
+        pointData.resize((pb + r.nPoints) * NDATA);
+        gaussData.resize((gb + r.nGauss) * NDATA);
+        lines.emplace_back();
+        lines.back().setLine(r.lID, r.nPoints, r.nGauss, pb, gb, r.x, r.y);
+        return lines.back();
+    }
+
+    static size_t packedBytes(const Line& l) {
+        return sizeof(LineRecord) + l.getNPoints() * (sizeof(Point) + NDATA * sizeof(float))
+             + l.getNGauss() * (sizeof(GaussPoint) + NDATA * sizeof(float));
+    }
+
+    // Serializes Line i at dst; returns the bytes written
+    size_t pack(int i, char* dst) const {
+        const Line& l = lines[i];
+        const LineRecord r = { l.getId(), l.getNPoints(), l.getNGauss(), l.getX(), l.getY() };
+        char* p = dst;
+        memcpy(p, &r, sizeof(r));
+        p += sizeof(r);
+        memcpy(p, &points[l.getPointBegin()], l.getNPoints() * sizeof(Point));
+        p += l.getNPoints() * sizeof(Point);
+        memcpy(p, &pointData[l.getPointBegin() * NDATA], l.getNPoints() * NDATA * sizeof(float));
+        p += l.getNPoints() * NDATA * sizeof(float);
+        memcpy(p, &gauss[l.getGaussBegin()], l.getNGauss() * sizeof(GaussPoint));
+        p += l.getNGauss() * sizeof(GaussPoint);
+        memcpy(p, &gaussData[l.getGaussBegin() * NDATA], l.getNGauss() * NDATA * sizeof(float));
+        p += l.getNGauss() * NDATA * sizeof(float);
+        return p - dst;
+    }
+
+    // Deserializes one Line from src; returns the bytes read
+    size_t unpack(const char* src) {
+        LineRecord r;
+        memcpy(&r, src, sizeof(r));
+        const Line& l = append(r);
+        const char* p = src + sizeof(r);
+        memcpy(&points[l.getPointBegin()], p, r.nPoints * sizeof(Point));
+        p += r.nPoints * sizeof(Point);
+        memcpy(&pointData[l.getPointBegin() * NDATA], p, r.nPoints * NDATA * sizeof(float));
+        p += r.nPoints * NDATA * sizeof(float);
+        memcpy(&gauss[l.getGaussBegin()], p, r.nGauss * sizeof(GaussPoint));
+        p += r.nGauss * sizeof(GaussPoint);
+        memcpy(&gaussData[l.getGaussBegin() * NDATA], p, r.nGauss * NDATA * sizeof(float));
+        p += r.nGauss * NDATA * sizeof(float);
+        return p - src;
+    }
+};
+
+// Hilbert index of (x, y) on a 2^16 x 2^16 grid
+uint64_t hilbertKey(float xf, float yf)
+{
+    const uint32_t n = 1u << 16;
+    uint32_t x = (uint32_t)std::min(xf * n, n - 1.0f), y = (uint32_t)std::min(yf * n, n - 1.0f);
+    uint64_t d = 0;
+    for (uint32_t s = n / 2; s > 0; s /= 2) {
+        const uint32_t rx = (x & s) ? 1 : 0, ry = (y & s) ? 1 : 0;
+        d += (uint64_t)s * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+// One time step on the rank's Lines (cost grows with the number of Points and GaussPoints)
+double computeStep(LineStore& s, int work)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    const int nl = (int)s.lines.size();
+    const long np = (long)s.points.size(), ng = (long)s.gauss.size();
+    Line* lines = s.lines.data();
+    float* pd = s.pointData.data();
+    float* gd = s.gaussData.data();
+    GaussPoint* gp = s.gauss.data();
+    #pragma acc parallel loop gang copyin(lines[0:nl], gp[0:ng]) copy(pd[0:np*NDATA], gd[0:ng*NDATA])
+    for (int l = 0; l < nl; ++l) {
+        const long pb = lines[l].getPointBegin(), gb = lines[l].getGaussBegin();
+        #pragma acc loop vector
+        for (int i = 0; i < lines[l].getNPoints(); ++i) {
+            for (int k = 0; k < NDATA; ++k) {
+                float v = pd[(pb + i) * NDATA + k];
+                for (int r = 0; r < work; ++r) {
+                    v = 0.999f * v + 0.001f * cosf(v);
+                }
+                pd[(pb + i) * NDATA + k] = v;
+            }
+        }
+        #pragma acc loop vector
+        for (int i = 0; i < lines[l].getNGauss(); ++i) {
+            for (int k = 0; k < NDATA; ++k) {
+                gd[(gb + i) * NDATA + k] += gp[gb + i].getWeight() * 1e-3f;
+            }
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Global checksum of ids and payloads, invariant under migration
+double checksum(const LineStore& s)
+{
+    double c = 0.0;
+    for (const Line& l : s.lines) {
+        c += l.getId();
+        for (int i = 0; i < l.getNPoints(); ++i) {
+            c += 1e-3 * s.points[l.getPointBegin() + i].getId();
+            for (int k = 0; k < NDATA; ++k) {
+                c += s.pointData[(l.getPointBegin() + i) * NDATA + k];
+            }
+        }
+        for (int i = 0; i < l.getNGauss(); ++i) {
+            for (int k = 0; k < NDATA; ++k) {
+                c += s.gaussData[(l.getGaussBegin() + i) * NDATA + k];
+            }
+        }
+    }
+    double g = 0.0;
+    MPI_Allreduce(&c, &g, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    return g;
+}
+
+// max / mean of a per-rank quantity
+double imbalance(double local, double& maxv, double& meanv)
+{
+    int size = 1;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Allreduce(&local, &maxv, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(&local, &meanv, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    meanv /= size;
+    return maxv / meanv;
+}
+
+/**
+ * @brief Moves Lines so every rank gets about the same measured load
+ *
+ * 1. each Line gets a weight: the rank's measured compute time split in proportion to its
+ *    points and Gauss points;
+ * 2. (Hilbert key, weight) pairs are gathered, sorted along the curve, and the curve is cut
+ *    into contiguous pieces of equal weight (a weighted 1D partition);
+ * 3. the moving Lines are packed per destination into one contiguous buffer and exchanged
+ *    with MPI_Alltoallv (counts first, with MPI_Alltoall);
+ * 4. the kept and received Lines are appended in curve order into the second store, whose
+ *    pools keep their capacity from previous migrations, and the stores are swapped.
+ */
+void migrate(LineStore& cur, LineStore& next, double measured, long& linesMoved, long& bytesMoved)
+{
+    int rank = 0, size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    const int nl = (int)cur.lines.size();
+
+    // 1. Per-line weights from the measured load
+    long units = 0;
+    for (const Line& l : cur.lines) {
+        units += l.getNPoints() + l.getNGauss();
+    }
+    struct KeyWeight { uint64_t key; double weight; };
+    std::vector<KeyWeight> mine(nl);
+    for (int i = 0; i < nl; ++i) {
+        const Line& l = cur.lines[i];
+        mine[i] = { hilbertKey(l.getX(), l.getY()), measured * (l.getNPoints() + l.getNGauss()) / std::max(1L, units) };
+    }
+
+    // 2. Weighted 1D partition of the gathered curve
+    std::vector<int> counts(size), displs(size);
+    const int nbytes = nl * (int)sizeof(KeyWeight);
+    MPI_Allgather(&nbytes, 1, MPI_INT, counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    for (int r = 1; r < size; ++r) {
+        displs[r] = displs[r - 1] + counts[r - 1];
+    }
+    std::vector<KeyWeight> all((displs[size - 1] + counts[size - 1]) / sizeof(KeyWeight));
+    MPI_Allgatherv(mine.data(), nbytes, MPI_BYTE, all.data(), counts.data(), displs.data(), MPI_BYTE, MPI_COMM_WORLD);
+    std::vector<double> w(all.size());
+    for (size_t i = 0; i < all.size(); ++i) {
+        w[i] = all[i].weight;
+    }
+    std::vector<size_t> order(all.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return all[a].key < all[b].key || (all[a].key == all[b].key && a < b);
+    });
+    double total = 0.0;
+    for (double v : w) {
+        total += v;
+    }
+    // Destination of every line, indexed like the gathered array; each piece gets its share of the weight
+    std::vector<int> destAll(all.size());
+    double acc = 0.0;
+    for (size_t k = 0; k < order.size(); ++k) {
+        const double mid = acc + 0.5 * w[order[k]];
+        destAll[order[k]] = std::min(size - 1, (int)(mid / total * size));
+        acc += w[order[k]];
+    }
+    const size_t myFirst = displs[rank] / sizeof(KeyWeight);
+
+    // 3. Pack per destination, then exchange sizes and buffers
+    std::vector<int> sendCounts(size, 0), recvCounts(size, 0), sendDispls(size, 0), recvDispls(size, 0);
+    linesMoved = 0;
+    for (int i = 0; i < nl; ++i) {
+        sendCounts[destAll[myFirst + i]] += (int)LineStore::packedBytes(cur.lines[i]);
+        linesMoved += (destAll[myFirst + i] != rank) ? 1 : 0;
+    }
+    for (int r = 1; r < size; ++r) {
+        sendDispls[r] = sendDispls[r - 1] + sendCounts[r - 1];
+    }
+    std::vector<char> sendBuf(sendDispls[size - 1] + sendCounts[size - 1]);
+    std::vector<int> fill(sendDispls);
+    for (int i = 0; i < nl; ++i) {
+        const int d = destAll[myFirst + i];
+        fill[d] += (int)cur.pack(i, sendBuf.data() + fill[d]);
+    }
+    MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    for (int r = 1; r < size; ++r) {
+        recvDispls[r] = recvDispls[r - 1] + recvCounts[r - 1];
+    }
+    std::vector<char> recvBuf(recvDispls[size - 1] + recvCounts[size - 1]);
+    MPI_Alltoallv(sendBuf.data(), sendCounts.data(), sendDispls.data(), MPI_BYTE,
+                  recvBuf.data(), recvCounts.data(), recvDispls.data(), MPI_BYTE, MPI_COMM_WORLD);
+    bytesMoved = (long)sendBuf.size() - sendCounts[rank];
+
+    // 4. Rebuild in curve order into the second store (pool capacity is reused)
+    next.clear();
+    std::vector<std::pair<uint64_t, size_t>> offsets;
+    for (size_t p = 0; p < recvBuf.size();) {
+        LineRecord r;
+        memcpy(&r, recvBuf.data() + p, sizeof(r));
+        offsets.push_back({ hilbertKey(r.x, r.y), p });
+        p += sizeof(LineRecord) + r.nPoints * (sizeof(Point) + NDATA * sizeof(float))
+           + r.nGauss * (sizeof(GaussPoint) + NDATA * sizeof(float));
+    }
+    std::sort(offsets.begin(), offsets.end());
+    for (const auto& o : offsets) {
+        next.unpack(recvBuf.data() + o.second);
+    }
+    std::swap(cur, next);
+}
+
+// Initial state: lines on a G x G grid, numbered row by row and split in equal-count blocks; lines in a refined disk carry many more points
+void buildInitial(LineStore& s, int nglobal, int rank, int size)
+{
+    const int G = (int)std::ceil(std::sqrt((double)nglobal));
+    const int first = (int)((long)nglobal * rank / size), last = (int)((long)nglobal * (rank + 1) / size);
+    for (int id = first; id < last; ++id) {
+        const float x = ((id % G) + 0.5f) / G, y = ((id / G) + 0.5f) / G;
+        const bool refined = (x - 0.25f) * (x - 0.25f) + (y - 0.25f) * (y - 0.25f) < 0.04f;
+        const LineRecord r = { id, refined ? 96 : 12, refined ? 48 : 6, x, y };
+        const Line& l = s.append(r);
+        for (int i = 0; i < r.nPoints; ++i) {
+            s.points[l.getPointBegin() + i].setPoint(id * 128 + i);
+            for (int k = 0; k < NDATA; ++k) {
+                s.pointData[(l.getPointBegin() + i) * NDATA + k] = 0.01f * k + 1e-4f * (id % 100);
+            }
+        }
+        for (int i = 0; i < r.nGauss; ++i) {
+            s.gauss[l.getGaussBegin() + i].setGaussPoint(id * 64 + i, 1.0f / r.nGauss);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    int rank = 0, size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    const int nglobal = (argc > 1) ? atoi(argv[1]) : 20000; // Global number of lines
+    const int nsteps = (argc > 2) ? atoi(argv[2]) : 5;      // Steps between and after balancing
+    const int work = (argc > 3) ? atoi(argv[3]) : 4;        // Inner iterations per payload entry
+
+    const bool model = (argc > 4) && strcmp(argv[4], "model") == 0; // Weights from the point counts instead of timings
+
+    LineStore cur, next;
+    buildInitial(cur, nglobal, rank, size);
+
+    auto measure = [&](const char* label) {
+        double t = 0.0;
+        for (int s = 0; s < nsteps; ++s) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            t += computeStep(cur, work);
+        }
+        long units = 0;
+        for (const Line& l : cur.lines) {
+            units += l.getNPoints() + l.getNGauss();
+        }
+        double maxT, meanT, maxU, meanU;
+        const double imbT = imbalance(t, maxT, meanT);
+        const double imbU = imbalance((double)units, maxU, meanU);
+        if (rank == 0) {
+            printf("%-7s: measured load max %.3f s / mean %.3f s = %.2f imbalance; points+gauss max %.0f / mean %.0f = %.2f\n",
+                   label, maxT, meanT, imbT, maxU, meanU, imbU);
+        }
+        std::vector<double> perRank(size);
+        MPI_Gather(&t, 1, MPI_DOUBLE, perRank.data(), 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        int nl = (int)cur.lines.size();
+        std::vector<int> linesPerRank(size);
+        MPI_Gather(&nl, 1, MPI_INT, linesPerRank.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+        if (rank == 0) {
+            for (int r = 0; r < size; ++r) {
+                printf("    rank %3d: %6d lines, %.3f s\n", r, linesPerRank[r], perRank[r]);
+            }
+        }
+        return t;
+    };
+
+    if (rank == 0) {
+        printf("%d lines on %d ranks, %d steps per measurement, %s weights\n", nglobal, size, nsteps, model ? "model" : "measured");
+    }
+    const double load = measure("before");
+    const double sum0 = checksum(cur);
+    long units = 0;
+    for (const Line& l : cur.lines) {
+        units += l.getNPoints() + l.getNGauss();
+    }
+
+    PUSH_RANGE("migrate", 1);
+    MPI_Barrier(MPI_COMM_WORLD);
+    const double t0 = MPI_Wtime();
+    long moved = 0, bytes = 0;
+    migrate(cur, next, model ? (double)units : load, moved, bytes);
+    const double tMigrate = MPI_Wtime() - t0;
+    POP_RANGE
+    long movedAll = 0, bytesAll = 0;
+    MPI_Reduce(&moved, &movedAll, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&bytes, &bytesAll, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    const double sum1 = checksum(cur);
+    if (rank == 0) {
+        printf("migrate: %ld lines moved, %.2f MB exchanged in %.3f s, checksum %s\n",
+               movedAll, 1e-6 * bytesAll, tMigrate, (std::fabs(sum1 - sum0) <= 1e-9 * std::fabs(sum0)) ? "preserved" : "CHANGED");
+    }
+    measure("after");
+
+    MPI_Finalize();
+    return 0;
+}
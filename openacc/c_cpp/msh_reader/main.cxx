@@ -0,0 +1,942 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Parallel Gmsh msh 4.1 reader (ASCII and binary) building flat Line/Point arrays
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// POSIX headers
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Run f(t, begin, end) on nthreads host threads over static blocks of [0, n)
+template <class F>
+void parallelBlocks(int nthreads, long n, F f)
+{
+    std::vector<std::thread> team;
+    for (int t = 1; t < nthreads; ++t) {
+        team.emplace_back(f, t, n * t / nthreads, n * (t + 1) / nthreads);
+    }
+    f(0, 0L, n / nthreads);
+    for (auto& th : team) {
+        th.join();
+    }
+}
+
+// Exclusive prefix sum in place over counts[0:n], counts[n] receives the total
+void exclusiveScan(long* counts, long n)
+{
+    long s = 0;
+    for (long i = 0; i < n; ++i) {
+        const long c = counts[i];
+        counts[i] = s;
+        s += c;
+    }
+    counts[n] = s;
+}
+
+// Nodes per element for the Gmsh element types handled here (0 = unsupported)
+int nodesPerElement(int type)
+{
+    switch (type) {
+        case 1:  return 2;  // 2-node line
+        case 2:  return 3;  // 3-node triangle
+        case 3:  return 4;  // 4-node quadrangle
+        case 4:  return 4;  // 4-node tetrahedron
+        case 5:  return 8;  // 8-node hexahedron
+        case 6:  return 6;  // 6-node prism
+        case 7:  return 5;  // 5-node pyramid
+        case 8:  return 3;  // 3-node line
+        case 9:  return 6;  // 6-node triangle
+        case 10: return 9;  // 9-node quadrangle
+        case 11: return 10; // 10-node tetrahedron
+        case 15: return 1;  // 1-node point
+        case 26: return 4;  // 4-node line
+        default: return 0;
+    }
+}
+
+// Line element types: their curves become Line objects
+inline bool isLineType(int type)
+{
+    return type == 1 || type == 8 || type == 26;
+}
+
+/**
+ * @brief Flat mesh arrays, filled directly by the parser
+ *
+ * Points are the mesh nodes (xyz, 3 per node). Elements are stored CSR-style with node indices
+ * (not Gmsh tags). Each curve entity with line elements becomes one Line, whose points are the
+ * primary nodes of its elements in order (linePoints[lineOffset[l]:lineOffset[l+1]]).
+ */
+struct Mesh
+{
+    long nNodes = 0;
+    long minTag = 0;
+    long maxTag = -1;
+    long* nodeTag = nullptr;    // Gmsh tag of each node
+    double* xyz = nullptr;      // Coordinates, 3 per node
+    long* tagToIndex = nullptr; // Node index of tag (minTag + i), -1 if unused
+    long nElems = 0;
+    int* elemType = nullptr;
+    long* elemOffset = nullptr; // CSR offsets into elemNodes, nElems + 1 entries
+    long* elemNodes = nullptr;  // Node indices
+    int nLines = 0;
+    int* lineTag = nullptr;     // Curve entity tag of each Line
+    long* lineOffset = nullptr; // CSR offsets into linePoints, nLines + 1 entries
+    long* linePoints = nullptr; // Node indices of the Points of each Line
+};
+
+void freeMesh(Mesh& m)
+{
+    free(m.nodeTag);
+    free(m.xyz);
+    free(m.tagToIndex);
+    free(m.elemType);
+    free(m.elemOffset);
+    free(m.elemNodes);
+    free(m.lineTag);
+    free(m.lineOffset);
+    free(m.linePoints);
+    m = Mesh();
+}
+
+// A contiguous run of node tags, node coordinates or elements, parsed by one thread
+enum ItemKind { NODE_TAGS, NODE_COORDS, ELEMENTS };
+
+struct Item
+{
+    int kind;
+    long first;    // First line (ASCII) or byte offset (binary)
+    long count;    // Entries in the item
+    long dest;     // First node or element written
+    long nodeBase; // ELEMENTS: first elemNodes slot
+    int npe;       // ELEMENTS: nodes per element; NODE_COORDS: values per node
+    int type;      // ELEMENTS: Gmsh element type
+};
+
+// Element block as found in the file
+struct ElemBlock
+{
+    int dim;
+    int tag;
+    int type;
+    long first; // First element
+    long count;
+};
+
+// Everything the header walk learns before any data is parsed
+struct Layout
+{
+    long numNodes = 0;
+    long minTag = 0;
+    long maxTag = -1;
+    long numElems = 0;
+    long numElemNodes = 0;
+    std::vector<Item> nodeItems;
+    std::vector<Item> elemItems;
+    std::vector<ElemBlock> blocks;
+};
+
+// Split an item into pieces of at most grain entries; unit is the advance of 'first' per entry
+void addItems(std::vector<Item>& items, Item it, long unit, long grain = 16384)
+{
+    while (it.count > 0) {
+        Item piece = it;
+        piece.count = std::min(grain, it.count);
+        items.push_back(piece);
+        it.first += piece.count * unit;
+        it.dest += piece.count;
+        it.nodeBase += piece.count * it.npe;
+        it.count -= piece.count;
+    }
+}
+
+// Text helpers: blanks are spaces, tabs and the '\r' of CRLF files
+inline const char* skipBlanks(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* nextLine(const char* p, const char* end)
+{
+    const char* q = (const char*)memchr(p, '\n', end - p);
+    return q ? q + 1 : end;
+}
+
+inline bool startsWith(const char* p, const char* end, const char* s)
+{
+    const size_t n = strlen(s);
+    return (size_t)(end - p) >= n && memcmp(p, s, n) == 0;
+}
+
+// Fast number parsing with std::from_chars; returns nullptr on a malformed field
+template <class T>
+inline const char* parseNum(const char* p, const char* end, T& v)
+{
+    p = skipBlanks(p, end);
+    const auto r = std::from_chars(p, end, v);
+    return (r.ec == std::errc()) ? r.ptr : nullptr;
+}
+
+// Unaligned load from the mapped file (binary sections follow text headers)
+template <class T>
+inline T load(const char* p)
+{
+    T v;
+    memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+/**
+ * @brief Sparse line index of a text buffer, built in parallel
+ *
+ * Records the byte offset of every STRIDE-th line, so the start of any line is found with at
+ * most STRIDE memchr calls. This is what lets threads start parsing in the middle of a block.
+ */
+class LineIndex
+{
+    private:
+        const char* buf;
+        const char* end;
+        long nlines;
+        std::vector<long> sample; // Byte offset of line m * STRIDE
+    public:
+        static constexpr long STRIDE = 256;
+
+        LineIndex(const char* b, size_t size, int nthreads) : buf(b), end(b + size) {
+            // Pass 1: newlines per chunk, then the global line number of each chunk
+            std::vector<long> counts(nthreads + 1, 0);
+            parallelBlocks(nthreads, (long)size, [&](int t, long begin, long stop) {
+                counts[t] = std::count(buf + begin, buf + stop, '\n');
+            });
+            exclusiveScan(counts.data(), nthreads);
+            nlines = counts[nthreads] + 1;
+            sample.assign(nlines / STRIDE + 1, 0);
+            // Pass 2: every chunk records the samples that fall inside it
+            parallelBlocks(nthreads, (long)size, [&](int t, long begin, long stop) {
+                long g = counts[t]; // Global index of the next newline
+                const char* p = buf + begin;
+                while ((p = (const char*)memchr(p, '\n', buf + stop - p)) != nullptr) {
+                    ++g;
+                    ++p;
+                    if (g % STRIDE == 0) {
+                        sample[g / STRIDE] = p - buf;
+                    }
+                }
+            });
+        }
+
+        long lines() const { return nlines; }
+
+        // Start of line k, or the end of the buffer past the last line
+        const char* lineStart(long k) const {
+            if (k < 0 || k >= nlines) {
+                return end;
+            }
+            const char* p = buf + sample[k / STRIDE];
+            for (long r = k % STRIDE; r > 0; --r) {
+                p = nextLine(p, end);
+            }
+            return p;
+        }
+};
+
+// Skip an unknown section "$Name ... $EndName" starting at line 'line'; returns the line after it
+long skipSectionAscii(const LineIndex& idx, long line, const char* end)
+{
+    const char* p = idx.lineStart(line);
+    while (p < end) {
+        p = nextLine(p, end);
+        ++line;
+        if (startsWith(p, end, "$End")) {
+            return line + 1;
+        }
+    }
+    return idx.lines();
+}
+
+// Header walk of an ASCII file: block headers are read serially, data only becomes items
+bool scanAscii(const char* buf, size_t size, const LineIndex& idx, Layout& L)
+{
+    const char* end = buf + size;
+    long line = 0;
+    while (line < idx.lines()) {
+        const char* p = idx.lineStart(line);
+        if (startsWith(p, end, "$Nodes")) {
+            long nb, nn;
+            p = idx.lineStart(line + 1);
+            p = parseNum(p, end, nb);
+            p = p ? parseNum(p, end, nn) : p;
+            p = p ? parseNum(p, end, L.minTag) : p;
+            p = p ? parseNum(p, end, L.maxTag) : p;
+            if (!p) {
+                fprintf(stderr, "Malformed $Nodes header\n");
+                return false;
+            }
+            L.numNodes = nn;
+            long cur = line + 2, dest = 0;
+            for (long b = 0; b < nb; ++b) {
+                int dim, tag, parametric;
+                long n;
+                p = idx.lineStart(cur);
+                p = parseNum(p, end, dim);
+                p = p ? parseNum(p, end, tag) : p;
+                p = p ? parseNum(p, end, parametric) : p;
+                p = p ? parseNum(p, end, n) : p;
+                if (!p) {
+                    fprintf(stderr, "Malformed node block header at line %ld\n", cur + 1);
+                    return false;
+                }
+                if (n < 0 || cur + 1 + 2 * n >= idx.lines()) {
+                    fprintf(stderr, "Truncated node block %ld\n", b);
+                    return false;
+                }
+                addItems(L.nodeItems, Item{ NODE_TAGS, cur + 1, n, dest, 0, 0, 0 }, 1);
+                addItems(L.nodeItems, Item{ NODE_COORDS, cur + 1 + n, n, dest, 0, 3, 0 }, 1);
+                dest += n;
+                cur += 1 + 2 * n;
+            }
+            line = cur + 1; // $EndNodes
+        } else if (startsWith(p, end, "$Elements")) {
+            long nb, ne, minTag, maxTag;
+            p = idx.lineStart(line + 1);
+            p = parseNum(p, end, nb);
+            p = p ? parseNum(p, end, ne) : p;
+            p = p ? parseNum(p, end, minTag) : p;
+            p = p ? parseNum(p, end, maxTag) : p;
+            if (!p) {
+                fprintf(stderr, "Malformed $Elements header\n");
+                return false;
+            }
+            L.numElems = ne;
+            long cur = line + 2, dest = 0;
+            for (long b = 0; b < nb; ++b) {
+                int dim, tag, type;
+                long n;
+                p = idx.lineStart(cur);
+                p = parseNum(p, end, dim);
+                p = p ? parseNum(p, end, tag) : p;
+                p = p ? parseNum(p, end, type) : p;
+                p = p ? parseNum(p, end, n) : p;
+                const int npe = p ? nodesPerElement(type) : 0;
+                if (npe == 0) {
+                    fprintf(stderr, "Malformed or unsupported element block at line %ld\n", cur + 1);
+                    return false;
+                }
+                if (n < 0 || cur + 1 + n >= idx.lines()) {
+                    fprintf(stderr, "Truncated element block %ld\n", b);
+                    return false;
+                }
+                L.blocks.push_back(ElemBlock{ dim, tag, type, dest, n });
+                addItems(L.elemItems, Item{ ELEMENTS, cur + 1, n, dest, L.numElemNodes, npe, type }, 1);
+                L.numElemNodes += n * npe;
+                dest += n;
+                cur += 1 + n;
+            }
+            line = cur + 1; // $EndElements
+        } else if (startsWith(p, end, "$")) {
+            line = skipSectionAscii(idx, line, end);
+        } else {
+            ++line;
+        }
+    }
+    return true;
+}
+
+// Parse one ASCII item: one entry per line
+bool parseItemAscii(const Item& it, const LineIndex& idx, const char* end, Mesh& m)
+{
+    const char* p = idx.lineStart(it.first);
+    for (long k = 0; k < it.count && p; ++k) {
+        const long i = it.dest + k;
+        if (it.kind == NODE_TAGS) {
+            p = parseNum(p, end, m.nodeTag[i]);
+        } else if (it.kind == NODE_COORDS) {
+            p = parseNum(p, end, m.xyz[3 * i]);
+            p = p ? parseNum(p, end, m.xyz[3 * i + 1]) : p;
+            p = p ? parseNum(p, end, m.xyz[3 * i + 2]) : p;
+        } else {
+            long tag;
+            const long base = it.nodeBase + k * it.npe;
+            m.elemType[i] = it.type;
+            m.elemOffset[i] = base;
+            p = parseNum(p, end, tag); // Element tag (unused)
+            for (int c = 0; c < it.npe && p; ++c) {
+                p = parseNum(p, end, tag);
+                const long t = tag - m.minTag;
+                if (p && (t < 0 || t > m.maxTag - m.minTag || m.tagToIndex[t] < 0)) {
+                    p = nullptr;
+                }
+                m.elemNodes[base + c] = p ? m.tagToIndex[t] : -1;
+            }
+        }
+        p = p ? nextLine(p, end) : p;
+    }
+    return p != nullptr;
+}
+
+// Skip whitespace between binary data and the next "$" line
+inline size_t skipSpaceBinary(const char* buf, size_t pos, size_t size)
+{
+    while (pos < size && (buf[pos] == '\n' || buf[pos] == '\r' || buf[pos] == ' ')) {
+        ++pos;
+    }
+    return pos;
+}
+
+// Header walk of a binary file (data-size 8): block sizes are known, so headers are found by arithmetic
+bool scanBinary(const char* buf, size_t size, size_t pos, Layout& L)
+{
+    const char* end = buf + size;
+    while ((pos = skipSpaceBinary(buf, pos, size)) < size) {
+        const char* p = buf + pos;
+        if (startsWith(p, end, "$Nodes")) {
+            pos = nextLine(p, end) - buf;
+            if (pos + 32 > size) {
+                fprintf(stderr, "Truncated $Nodes header\n");
+                return false;
+            }
+            const long nb = (long)load<size_t>(buf + pos);
+            L.numNodes = (long)load<size_t>(buf + pos + 8);
+            L.minTag = (long)load<size_t>(buf + pos + 16);
+            L.maxTag = (long)load<size_t>(buf + pos + 24);
+            pos += 32;
+            long dest = 0;
+            for (long b = 0; b < nb; ++b) {
+                if (pos + 20 > size) {
+                    fprintf(stderr, "Truncated node block %ld\n", b);
+                    return false;
+                }
+                const int dim = load<int>(buf + pos);
+                const int parametric = load<int>(buf + pos + 8);
+                const long n = (long)load<size_t>(buf + pos + 12);
+                const int nv = 3 + (parametric ? dim : 0);
+                pos += 20;
+                if (pos + (size_t)n * 8 * (1 + nv) > size) {
+                    fprintf(stderr, "Truncated node block %ld\n", b);
+                    return false;
+                }
+                addItems(L.nodeItems, Item{ NODE_TAGS, (long)pos, n, dest, 0, 0, 0 }, 8);
+                pos += n * 8;
+                addItems(L.nodeItems, Item{ NODE_COORDS, (long)pos, n, dest, 0, nv, 0 }, 8L * nv);
+                pos += n * 8 * nv;
+                dest += n;
+            }
+            pos = nextLine(buf + skipSpaceBinary(buf, pos, size), end) - buf; // $EndNodes
+        } else if (startsWith(p, end, "$Elements")) {
+            pos = nextLine(p, end) - buf;
+            if (pos + 32 > size) {
+                fprintf(stderr, "Truncated $Elements header\n");
+                return false;
+            }
+            const long nb = (long)load<size_t>(buf + pos);
+            L.numElems = (long)load<size_t>(buf + pos + 8);
+            pos += 32;
+            long dest = 0;
+            for (long b = 0; b < nb; ++b) {
+                if (pos + 20 > size) {
+                    fprintf(stderr, "Truncated element block %ld\n", b);
+                    return false;
+                }
+                const int dim = load<int>(buf + pos);
+                const int tag = load<int>(buf + pos + 4);
+                const int type = load<int>(buf + pos + 8);
+                const long n = (long)load<size_t>(buf + pos + 12);
+                const int npe = nodesPerElement(type);
+                pos += 20;
+                if (npe == 0 || pos + (size_t)n * 8 * (1 + npe) > size) {
+                    fprintf(stderr, "Truncated or unsupported element block %ld\n", b);
+                    return false;
+                }
+                L.blocks.push_back(ElemBlock{ dim, tag, type, dest, n });
+                addItems(L.elemItems, Item{ ELEMENTS, (long)pos, n, dest, L.numElemNodes, npe, type }, 8L * (1 + npe));
+                L.numElemNodes += n * npe;
+                pos += n * 8 * (1 + npe);
+                dest += n;
+            }
+            pos = nextLine(buf + skipSpaceBinary(buf, pos, size), end) - buf; // $EndElements
+        } else if (startsWith(p, end, "$")) {
+            // Unknown section: find "$End<Name>"
+            const char* nameEnd = p + 1;
+            while (nameEnd < end && *nameEnd != '\n' && *nameEnd != '\r') {
+                ++nameEnd;
+            }
+            const std::string closing = "$End" + std::string(p + 1, nameEnd);
+            const char* q = (const char*)memmem(nameEnd, end - nameEnd, closing.data(), closing.size());
+            pos = q ? nextLine(q, end) - buf : size;
+        } else {
+            fprintf(stderr, "Unexpected data at byte %zu\n", pos);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Parse one binary item: fixed-size records, so this is mostly unaligned copies
+bool parseItemBinary(const Item& it, const char* buf, Mesh& m)
+{
+    const char* p = buf + it.first;
+    if (it.kind == NODE_TAGS) {
+        for (long k = 0; k < it.count; ++k) {
+            m.nodeTag[it.dest + k] = (long)load<size_t>(p + 8 * k);
+        }
+    } else if (it.kind == NODE_COORDS) {
+        if (it.npe == 3) {
+            memcpy(&m.xyz[3 * it.dest], p, it.count * 3 * sizeof(double));
+        } else {
+            for (long k = 0; k < it.count; ++k) {
+                memcpy(&m.xyz[3 * (it.dest + k)], p + k * 8 * it.npe, 3 * sizeof(double));
+            }
+        }
+    } else {
+        const long span = m.maxTag - m.minTag;
+        for (long k = 0; k < it.count; ++k) {
+            const char* rec = p + k * 8 * (1 + it.npe);
+            const long i = it.dest + k;
+            const long base = it.nodeBase + k * it.npe;
+            m.elemType[i] = it.type;
+            m.elemOffset[i] = base;
+            for (int c = 0; c < it.npe; ++c) {
+                const long t = (long)load<size_t>(rec + 8 * (1 + c)) - m.minTag;
+                if (t < 0 || t > span || m.tagToIndex[t] < 0) {
+                    return false;
+                }
+                m.elemNodes[base + c] = m.tagToIndex[t];
+            }
+        }
+    }
+    return true;
+}
+
+// Run the items on nthreads threads, taking them in order from a shared counter
+template <class F>
+bool runItems(const std::vector<Item>& items, int nthreads, F parse)
+{
+    std::atomic<size_t> next(0);
+    std::atomic<bool> ok(true);
+    parallelBlocks(nthreads, nthreads, [&](int, long, long) {
+        size_t i;
+        while ((i = next.fetch_add(1)) < items.size() && ok.load(std::memory_order_relaxed)) {
+            if (!parse(items[i])) {
+                ok = false;
+            }
+        }
+    });
+    return ok;
+}
+
+/**
+ * @brief Fill the mesh from the layout: nodes, tag map, elements, then Lines
+ *
+ * Arrays are allocated once with their final sizes (no intermediate containers); every
+ * parallel phase writes disjoint ranges.
+ */
+template <class F>
+bool buildMesh(const Layout& L, int nthreads, Mesh& m, F parse)
+{
+    m.nNodes = L.numNodes;
+    m.minTag = L.minTag;
+    m.maxTag = L.maxTag;
+    m.nodeTag = (long*)malloc(m.nNodes * sizeof(long));
+    m.xyz = (double*)malloc(3 * m.nNodes * sizeof(double));
+    m.nElems = L.numElems;
+    m.elemType = (int*)malloc(m.nElems * sizeof(int));
+    m.elemOffset = (long*)malloc((m.nElems + 1) * sizeof(long));
+    m.elemNodes = (long*)malloc(L.numElemNodes * sizeof(long));
+
+    if (!runItems(L.nodeItems, nthreads, parse)) {
+        fprintf(stderr, "Malformed node data\n");
+        return false;
+    }
+
+    // Tag to index map over [minTag, maxTag]
+    const long span = m.maxTag - m.minTag + 1;
+    m.tagToIndex = (long*)malloc(std::max(span, 1L) * sizeof(long));
+    parallelBlocks(nthreads, span, [&](int, long begin, long end) {
+        std::fill(m.tagToIndex + begin, m.tagToIndex + end, -1L);
+    });
+    std::atomic<bool> tagsOk(true);
+    parallelBlocks(nthreads, m.nNodes, [&](int, long begin, long end) {
+        for (long i = begin; i < end; ++i) {
+            const long t = m.nodeTag[i] - m.minTag;
+            if (t < 0 || t >= span) {
+                tagsOk = false;
+                return;
+            }
+            m.tagToIndex[t] = i;
+        }
+    });
+    if (!tagsOk) {
+        fprintf(stderr, "Node tag outside [%ld, %ld]\n", m.minTag, m.maxTag);
+        return false;
+    }
+
+    if (!runItems(L.elemItems, nthreads, parse)) {
+        fprintf(stderr, "Malformed element data or unknown node tag\n");
+        return false;
+    }
+    m.elemOffset[m.nElems] = L.numElemNodes;
+
+    // Lines: one per block of line elements, Points are the primary nodes in element order
+    std::vector<const ElemBlock*> lineBlocks;
+    for (const ElemBlock& b : L.blocks) {
+        if (isLineType(b.type) && b.count > 0) {
+            lineBlocks.push_back(&b);
+        }
+    }
+    m.nLines = (int)lineBlocks.size();
+    m.lineTag = (int*)malloc(std::max(m.nLines, 1) * sizeof(int));
+    m.lineOffset = (long*)malloc((m.nLines + 1) * sizeof(long));
+    for (int l = 0; l < m.nLines; ++l) {
+        m.lineTag[l] = lineBlocks[l]->tag;
+        m.lineOffset[l] = lineBlocks[l]->count + 1;
+    }
+    exclusiveScan(m.lineOffset, m.nLines);
+    m.linePoints = (long*)malloc(std::max(m.lineOffset[m.nLines], 1L) * sizeof(long));
+    parallelBlocks(nthreads, m.nLines, [&](int, long begin, long end) {
+        for (long l = begin; l < end; ++l) {
+            const ElemBlock& b = *lineBlocks[l];
+            long* pts = m.linePoints + m.lineOffset[l];
+            for (long k = 0; k < b.count; ++k) {
+                pts[k] = m.elemNodes[m.elemOffset[b.first + k]];
+            }
+            pts[b.count] = m.elemNodes[m.elemOffset[b.first + b.count - 1] + 1];
+        }
+    });
+    return true;
+}
+
+// Memory-mapped read-only file
+class MappedFile
+{
+    private:
+        int fd = -1;
+        char* ptr = nullptr;
+        size_t len = 0;
+    public:
+        bool open(const char* path) {
+            fd = ::open(path, O_RDONLY);
+            struct stat st;
+            if (fd < 0 || fstat(fd, &st) != 0) {
+                perror(path);
+                return false;
+            }
+            len = (size_t)st.st_size;
+            ptr = (char*)mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED) {
+                ptr = nullptr;
+                perror("mmap");
+                return false;
+            }
+            madvise(ptr, len, MADV_SEQUENTIAL);
+            return true;
+        }
+        ~MappedFile() {
+            if (ptr) {
+                munmap(ptr, len);
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+        const char* data() const { return ptr; }
+        size_t size() const { return len; }
+};
+
+// Read a msh 4.1 file (ASCII or binary, detected from $MeshFormat); returns false on error
+bool readMsh(const char* path, int nthreads, Mesh& m, double& seconds, size_t& bytes, bool& binary)
+{
+    MappedFile f;
+    if (!f.open(path)) {
+        return false;
+    }
+    const auto t0 = std::chrono::steady_clock::now();
+    const char* buf = f.data();
+    const char* end = buf + f.size();
+    bytes = f.size();
+
+    // $MeshFormat: version file-type data-size
+    if (!startsWith(buf, end, "$MeshFormat")) {
+        fprintf(stderr, "%s: not a Gmsh msh file\n", path);
+        return false;
+    }
+    double version;
+    int fileType, dataSize;
+    const char* p = nextLine(buf, end);
+    p = parseNum(p, end, version);
+    p = p ? parseNum(p, end, fileType) : p;
+    p = p ? parseNum(p, end, dataSize) : p;
+    if (!p || version < 4.1 || version >= 5.0 || dataSize != 8) {
+        fprintf(stderr, "%s: only msh 4.1 with 8-byte size_t is supported\n", path);
+        return false;
+    }
+    binary = (fileType == 1);
+    p = nextLine(p, end);
+
+    Layout L;
+    bool ok;
+    if (binary) {
+        if (load<int>(p) != 1) {
+            fprintf(stderr, "%s: binary file with foreign endianness\n", path);
+            return false;
+        }
+        p = nextLine(p + sizeof(int), end); // Rest of the line after the endianness check
+        p = nextLine(p, end);               // $EndMeshFormat
+        ok = scanBinary(buf, f.size(), p - buf, L) &&
+             buildMesh(L, nthreads, m, [&](const Item& it) { return parseItemBinary(it, buf, m); });
+    } else {
+        const LineIndex idx(buf, f.size(), nthreads);
+        ok = scanAscii(buf, f.size(), idx, L) &&
+             buildMesh(L, nthreads, m, [&](const Item& it) { return parseItemAscii(it, idx, end, m); });
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return ok;
+}
+
+// Buffered writer for the synthetic files
+class Writer
+{
+    private:
+        FILE* fp;
+        std::string buf;
+    public:
+        explicit Writer(FILE* f) : fp(f) { buf.reserve(1 << 20); }
+        ~Writer() { flush(); }
+        void flush() { fwrite(buf.data(), 1, buf.size(), fp); buf.clear(); }
+        void text(const char* s) { buf.append(s); check(); }
+        template <class T>
+        void num(T v, char sep) {
+            char tmp[32];
+            char* e = std::to_chars(tmp, tmp + sizeof(tmp), v).ptr;
+            *e++ = sep;
+            buf.append(tmp, e);
+            check();
+        }
+        template <class T>
+        void raw(const T& v) { buf.append((const char*)&v, sizeof(T)); check(); }
+        void check() { if (buf.size() > (1u << 20)) flush(); }
+};
+
+/**
+ * @brief Write a synthetic mesh of nlines curves with np nodes and np - 1 line elements each
+ *
+ * Curve l is the segment y = 0.01 l, x in [0, 1]; node tags are 1-based and global. The same
+ * mesh is written as ASCII and as binary msh 4.1.
+ */
+void writeSynthetic(const char* path, bool binary, int nlines, int np)
+{
+    FILE* fp = fopen(path, "wb");
+    Writer w(fp);
+    const size_t nn = (size_t)nlines * np, ne = (size_t)nlines * (np - 1);
+    const double h = 1.0 / (np - 1);
+    w.text(binary ? "$MeshFormat\n4.1 1 8\n" : "$MeshFormat\n4.1 0 8\n");
+    if (binary) {
+        w.raw(1);
+        w.text("\n");
+    }
+    w.text("$EndMeshFormat\n$Nodes\n");
+    if (binary) {
+        w.raw((size_t)nlines); w.raw(nn); w.raw((size_t)1); w.raw(nn);
+    } else {
+        w.num(nlines, ' '); w.num(nn, ' '); w.num(1, ' '); w.num(nn, '\n');
+    }
+    for (int l = 0; l < nlines; ++l) {
+        const size_t tag0 = (size_t)l * np + 1;
+        if (binary) {
+            w.raw(1); w.raw(l + 1); w.raw(0); w.raw((size_t)np);
+            for (int i = 0; i < np; ++i) {
+                w.raw(tag0 + i);
+            }
+            for (int i = 0; i < np; ++i) {
+                w.raw(i * h); w.raw(0.01 * l); w.raw(0.0);
+            }
+        } else {
+            w.num(1, ' '); w.num(l + 1, ' '); w.num(0, ' '); w.num(np, '\n');
+            for (int i = 0; i < np; ++i) {
+                w.num(tag0 + i, '\n');
+            }
+            for (int i = 0; i < np; ++i) {
+                w.num(i * h, ' '); w.num(0.01 * l, ' '); w.num(0.0, '\n');
+            }
+        }
+    }
+    w.text(binary ? "\n$EndNodes\n$Elements\n" : "$EndNodes\n$Elements\n");
+    if (binary) {
+        w.raw((size_t)nlines); w.raw(ne); w.raw((size_t)1); w.raw(ne);
+    } else {
+        w.num(nlines, ' '); w.num(ne, ' '); w.num(1, ' '); w.num(ne, '\n');
+    }
+    size_t etag = 1;
+    for (int l = 0; l < nlines; ++l) {
+        const size_t tag0 = (size_t)l * np + 1;
+        if (binary) {
+            w.raw(1); w.raw(l + 1); w.raw(1); w.raw((size_t)(np - 1));
+        } else {
+            w.num(1, ' '); w.num(l + 1, ' '); w.num(1, ' '); w.num(np - 1, '\n');
+        }
+        for (int i = 0; i < np - 1; ++i, ++etag) {
+            if (binary) {
+                w.raw(etag); w.raw(tag0 + i); w.raw(tag0 + i + 1);
+            } else {
+                w.num(etag, ' '); w.num(tag0 + i, ' '); w.num(tag0 + i + 1, '\n');
+            }
+        }
+    }
+    w.text(binary ? "\n$EndElements\n" : "$EndElements\n");
+    w.flush();
+    fclose(fp);
+}
+
+// Length of every Line, computed from the flat arrays on the device
+void lineLengths(const Mesh& m, double* len)
+{
+    const int nl = m.nLines;
+    [[maybe_unused]] const long nn = m.nNodes; // Sizes only referenced by the data clauses
+    [[maybe_unused]] const long npts = m.lineOffset[nl];
+    const long* off = m.lineOffset;
+    const long* pts = m.linePoints;
+    const double* xyz = m.xyz;
+    #pragma acc parallel loop gang copyin(off[0:nl+1], pts[0:npts], xyz[0:3*nn]) copyout(len[0:nl])
+    for (int l = 0; l < nl; ++l) {
+        double s = 0.0;
+        #pragma acc loop vector reduction(+:s)
+        for (long k = off[l]; k < off[l + 1] - 1; ++k) {
+            const double* a = &xyz[3 * pts[k]];
+            const double* b = &xyz[3 * pts[k + 1]];
+            s += sqrt((b[0] - a[0]) * (b[0] - a[0]) + (b[1] - a[1]) * (b[1] - a[1]) + (b[2] - a[2]) * (b[2] - a[2]));
+        }
+        len[l] = s;
+    }
+}
+
+// Parse one file with nthreads and print throughput and a summary; returns the mesh
+bool report(const char* path, int nthreads, Mesh& m)
+{
+    double t;
+    size_t bytes;
+    bool binary;
+    if (!readMsh(path, nthreads, m, t, bytes, binary)) {
+        freeMesh(m);
+        return false;
+    }
+    printf("%-7s | %2d threads | %8.1f MB | %8.3f s | %8.1f MB/s | %ld nodes, %ld elements, %d lines\n",
+           binary ? "binary" : "ASCII", nthreads, bytes / 1.0e6, t, bytes / t * 1.0e-6, m.nNodes, m.nElems, m.nLines);
+    return true;
+}
+
+int main(int argc, const char** argv)
+{
+    const bool synthetic = (argc < 2) || strcmp(argv[1], "-") == 0;
+    const int hw = (argc > 2) ? atoi(argv[2]) : (int)std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> threads = { 1 };
+    if (hw > 1) {
+        threads.push_back(hw);
+    }
+
+    // A real mesh: parse it and report
+    if (!synthetic) {
+        for (int nt : threads) {
+            Mesh m;
+            if (!report(argv[1], nt, m)) {
+                return 1;
+            }
+            freeMesh(m);
+        }
+        return 0;
+    }
+
+    // No file: synthetic mesh written in both formats, parsed and cross-checked
+    const int nlines = 2000, np = 500;
+    const char* files[2] = { "msh_reader_synthetic_ascii.msh", "msh_reader_synthetic_binary.msh" };
+    printf("Writing synthetic mesh: %d lines x %d points\n", nlines, np);
+    writeSynthetic(files[0], false, nlines, np);
+    writeSynthetic(files[1], true, nlines, np);
+
+    Mesh m[2];
+    for (int f = 0; f < 2; ++f) {
+        for (int nt : threads) {
+            freeMesh(m[f]);
+            if (!report(files[f], nt, m[f])) {
+                return 1;
+            }
+        }
+    }
+
+    // Both formats give the same flat arrays, and the Lines have the expected geometry
+    bool same = m[0].nNodes == m[1].nNodes && m[0].nElems == m[1].nElems && m[0].nLines == m[1].nLines &&
+                memcmp(m[0].xyz, m[1].xyz, 3 * m[0].nNodes * sizeof(double)) == 0 &&
+                memcmp(m[0].elemNodes, m[1].elemNodes, m[0].elemOffset[m[0].nElems] * sizeof(long)) == 0 &&
+                memcmp(m[0].linePoints, m[1].linePoints, m[0].lineOffset[m[0].nLines] * sizeof(long)) == 0;
+    double* len = (double*)malloc(m[0].nLines * sizeof(double));
+    lineLengths(m[0], len);
+    double err = 0.0;
+    for (int l = 0; l < m[0].nLines; ++l) {
+        err = std::max(err, std::fabs(len[l] - 1.0));
+    }
+    printf("ASCII and binary arrays identical: %s, max |line length - 1| = %.1e\n", same ? "yes" : "no", err);
+
+    free(len);
+    freeMesh(m[0]);
+    freeMesh(m[1]);
+    remove(files[0]);
+    remove(files[1]);
+    return (same && err < 1.0e-9) ? 0 : 1;
+}
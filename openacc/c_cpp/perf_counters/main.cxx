@@ -0,0 +1,429 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Hardware performance counters (perf_event_open) attributed to named profiling ranges
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+// Linux perf headers
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define NVTX_PUSH(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define NVTX_POP nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define NVTX_PUSH(name,cid) {}
+#define NVTX_POP
+#endif
+
+// Number of counters read per range
+#define NUM_COUNTERS 7
+
+// Hardware/software events captured around every range
+struct CounterSpec
+{
+    const char* name; // Column label
+    uint32_t type;    // perf_event_attr::type
+    uint64_t config;  // perf_event_attr::config
+    int group;        // Counters sharing a group are scheduled together
+};
+
+#ifdef __linux__
+#define HW_CACHE_EVENT(cache, op, result) \
+    ((uint64_t)(cache) | ((uint64_t)(op) << 8) | ((uint64_t)(result) << 16))
+
+const CounterSpec counterSpecs[NUM_COUNTERS] = {
+    { "cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, 0 },
+    { "instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, 0 },
+    { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, 0 },
+    { "L1D-misses",    PERF_TYPE_HW_CACHE, HW_CACHE_EVENT(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS), 1 },
+    { "LLC-misses",    PERF_TYPE_HW_CACHE, HW_CACHE_EVENT(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS), 1 },
+    { "dTLB-misses",   PERF_TYPE_HW_CACHE, HW_CACHE_EVENT(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS), 1 },
+    { "task-clock[ns]", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, 2 },
+};
+#define NUM_GROUPS 3
+#endif
+
+// Per-thread set of perf_event groups. Counters that cannot be opened are marked unavailable.
+class PerfGroups
+{
+    private:
+        int fds[NUM_COUNTERS];       // File descriptor per counter (-1 if unavailable)
+        int leaders[NUM_COUNTERS];   // Group leader fd per group (-1 if the group is empty)
+        int slot[NUM_COUNTERS];      // Position of each counter inside its group read buffer
+    public:
+        PerfGroups() {
+            for (int c = 0; c < NUM_COUNTERS; ++c) {
+                fds[c] = -1;
+                leaders[c] = -1;
+                slot[c] = -1;
+            }
+#ifdef __linux__
+            int members[NUM_GROUPS] = {0};
+            for (int c = 0; c < NUM_COUNTERS; ++c) {
+                const int g = counterSpecs[c].group;
+                perf_event_attr attr;
+                memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = counterSpecs[c].type;
+                attr.config = counterSpecs[c].config;
+                attr.disabled = (leaders[g] < 0) ? 1 : 0; // Only the leader starts disabled
+                attr.exclude_kernel = 1;                  // Works with perf_event_paranoid <= 2
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                // pid = 0, cpu = -1: this thread, on whatever core it runs
+                int fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, leaders[g], 0);
+                if (fd < 0) {
+                    continue;
+                }
+                fds[c] = fd;
+                if (leaders[g] < 0) {
+                    leaders[g] = fd;
+                }
+                slot[c] = members[g]++;
+            }
+            for (int g = 0; g < NUM_GROUPS; ++g) {
+                if (leaders[g] >= 0) {
+                    ioctl(leaders[g], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                    ioctl(leaders[g], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+                }
+            }
+#endif
+        }
+
+        ~PerfGroups() {
+#ifdef __linux__
+            for (int c = 0; c < NUM_COUNTERS; ++c) {
+                if (fds[c] >= 0) {
+                    close(fds[c]);
+                }
+            }
+#endif
+        }
+
+        bool available(int c) const { return fds[c] >= 0; }
+
+        // Read all counters; values are scaled when the kernel multiplexed a group.
+        // A group that was never scheduled leaves its counters at -1.
+        void read(double* values) const {
+            for (int c = 0; c < NUM_COUNTERS; ++c) {
+                values[c] = -1.0;
+            }
+#ifdef __linux__
+            for (int c = 0; c < NUM_COUNTERS; ++c) {
+                const int g = counterSpecs[c].group;
+                if (fds[c] < 0 || leaders[g] != fds[c]) {
+                    continue;
+                }
+                // Layout with PERF_FORMAT_GROUP: nr, time_enabled, time_running, value[nr]
+                uint64_t buf[3 + NUM_COUNTERS];
+                if (::read(leaders[g], buf, sizeof(buf)) <= 0 || buf[2] == 0) {
+                    continue;
+                }
+                const double scale = (double)buf[1] / (double)buf[2];
+                for (int m = 0; m < NUM_COUNTERS; ++m) {
+                    if (fds[m] >= 0 && counterSpecs[m].group == g) {
+                        values[m] = (double)buf[3 + slot[m]] * scale;
+                    }
+                }
+            }
+#endif
+        }
+};
+
+// Counter totals of one named range on one thread
+struct RangeCounters
+{
+    std::string name;             // Range name
+    int calls;                    // Times the range was closed
+    double total[NUM_COUNTERS];   // Accumulated deltas (-1 if unavailable)
+};
+
+// Per-thread range stack: deltas between push and pop are attributed to the range name (inclusive)
+class PerfRanges
+{
+    private:
+        PerfGroups groups;                       // Counters of this thread
+        std::vector<RangeCounters> table;        // Totals per range name
+        std::vector<int> stack;                  // Open ranges (indices into table)
+        std::vector<std::vector<double>> starts; // Counter values when each open range was pushed
+    public:
+
+        void push(const char* name) {
+            int idx = -1;
+            for (size_t r = 0; r < table.size(); ++r) {
+                if (table[r].name == name) {
+                    idx = (int)r;
+                }
+            }
+            if (idx < 0) {
+                RangeCounters rc;
+                rc.name = name;
+                rc.calls = 0;
+                for (int c = 0; c < NUM_COUNTERS; ++c) {
+                    rc.total[c] = 0.0;
+                }
+                table.push_back(rc);
+                idx = (int)table.size() - 1;
+            }
+            std::vector<double> v(NUM_COUNTERS);
+            stack.push_back(idx);
+            starts.push_back(v);
+            // Read last, so the bookkeeping above is not counted
+            groups.read(starts.back().data());
+        }
+
+        void pop() {
+            double now[NUM_COUNTERS];
+            groups.read(now);
+            if (stack.empty()) {
+                return;
+            }
+            RangeCounters& rc = table[stack.back()];
+            const std::vector<double>& s = starts.back();
+            for (int c = 0; c < NUM_COUNTERS; ++c) {
+                if (now[c] < 0.0 || s[c] < 0.0 || rc.total[c] < 0.0) {
+                    rc.total[c] = -1.0;
+                } else {
+                    rc.total[c] += now[c] - s[c];
+                }
+            }
+            rc.calls += 1;
+            stack.pop_back();
+            starts.pop_back();
+        }
+
+        void report(int thread) const {
+            printf("\nHardware counters per range (thread %d)\n", thread);
+            printf("%-28s %6s", "Range", "Calls");
+            for (int c = 0; c < NUM_COUNTERS; ++c) {
+#ifdef __linux__
+                printf(" %14s", counterSpecs[c].name);
+#endif
+            }
+            printf(" %8s\n", "IPC");
+            for (const RangeCounters& rc : table) {
+                printf("%-28s %6d", rc.name.c_str(), rc.calls);
+                for (int c = 0; c < NUM_COUNTERS; ++c) {
+                    if (rc.total[c] < 0.0) {
+                        printf(" %14s", "n/a");
+                    } else {
+                        printf(" %14.0f", rc.total[c]);
+                    }
+                }
+                if (rc.total[0] > 0.0 && rc.total[1] >= 0.0) {
+                    printf(" %8.2f\n", rc.total[1] / rc.total[0]);
+                } else {
+                    printf(" %8s\n", "n/a");
+                }
+            }
+            int missing = 0;
+            for (int c = 0; c < NUM_COUNTERS; ++c) {
+                missing += groups.available(c) ? 0 : 1;
+            }
+            if (missing > 0) {
+                printf("(%d counter(s) could not be opened: check /proc/sys/kernel/perf_event_paranoid"
+                       " and whether the PMU is exposed to this machine)\n", missing);
+            }
+        }
+};
+
+// Registry of every thread's ranges, so a single report covers all threads
+std::mutex perfRegistryMutex;
+std::vector<PerfRanges*> perfRegistry;
+
+// Counters of the calling thread, created (and registered) on first use
+PerfRanges& perfRanges()
+{
+    thread_local PerfRanges* ranges = nullptr;
+    if (!ranges) {
+        ranges = new PerfRanges();
+        std::lock_guard<std::mutex> lock(perfRegistryMutex);
+        perfRegistry.push_back(ranges);
+    }
+    return *ranges;
+}
+
+void perfReport()
+{
+    std::lock_guard<std::mutex> lock(perfRegistryMutex);
+    for (size_t t = 0; t < perfRegistry.size(); ++t) {
+        perfRegistry[t]->report((int)t);
+    }
+}
+
+// Ranges: NVTX for the timeline plus counter capture for the table
+#define PUSH_RANGE(name,cid) { NVTX_PUSH(name,cid) perfRanges().push(name); }
+#define POP_RANGE { perfRanges().pop(); NVTX_POP }
+
+// Point class containing an id and a dynamic float array (from array_of_objects)
+class Point
+{
+    private:
+        int pID;      // Unique identifier for the Point
+        int dataSize; // Size of the data array in elements
+        float* pData; // Data pointer as a dynamic array of floats
+    public:
+        float* getData() const { return pData; }
+        void setPoint(int id, int n, float* data) {
+            this->pID = id;
+            this->dataSize = n;
+            this->pData = data;
+        }
+};
+
+// Line class contains an array of Point objects (from array_of_objects)
+class Line
+{
+    private:
+        int lID;       // Unique identifier for the Line
+        int nPoints;   // Number of Point objects in this Line
+        Point* points; // Pointer to an array of Point objects
+    public:
+        Point* getPoints() const { return points; }
+        void setLine(int id, int np) {
+            this->lID = id;
+            this->nPoints = np;
+            this->points = (Point*)calloc(np, sizeof(Point));
+        }
+};
+
+int main(int argc, const char** argv)
+{
+    // Large enough to exceed the caches and the TLB reach
+    const int np = 64;                                      // Points per line
+    const int ndata = 4;                                    // Data entries per point
+    const int nlines = (argc > 1) ? atoi(argv[1]) : 65536;  // Number of lines
+    const long npts = (long)nlines * np;
+
+    // Object hierarchy: each payload is its own heap block, visited in a scattered order
+    PUSH_RANGE("main::build_objects", 0);
+    Line* lines = (Line*)calloc(nlines, sizeof(Line));
+    float** blocks = (float**)malloc(npts * sizeof(float*));
+    for (long p = 0; p < npts; ++p) {
+        blocks[p] = (float*)calloc(ndata, sizeof(float));
+    }
+    // Deterministic shuffle of the payload blocks (mimics a fragmented heap)
+    uint64_t seed = 12345;
+    for (long p = npts - 1; p > 0; --p) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        long q = (long)((seed >> 33) % (uint64_t)(p + 1));
+        std::swap(blocks[p], blocks[q]);
+    }
+    for (int i = 0; i < nlines; ++i) {
+        lines[i].setLine(i, np);
+        for (int j = 0; j < np; ++j) {
+            lines[i].getPoints()[j].setPoint(i * np + j, ndata, blocks[(long)i * np + j]);
+        }
+    }
+    POP_RANGE
+
+    // Flat layout: same payload in one contiguous [line][point][component] array
+    PUSH_RANGE("main::build_flat", 0);
+    float* flat = (float*)calloc(npts * ndata, sizeof(float));
+    // Fault the pages in here, not inside the kernel (volatile: the stores must not be elided)
+    volatile float* touch = flat;
+    for (long e = 0; e < npts * ndata; e += 1024) {
+        touch[e] = 0.0f;
+    }
+    POP_RANGE
+
+    // kernel_1 + kernel_2 of array_of_objects through the pointer hierarchy
+    PUSH_RANGE("main::kernel_objects", 1);
+    for (int i = 0; i < nlines; ++i) {
+        Point* points = lines[i].getPoints();
+        for (int j = 0; j < np; ++j) {
+            float* data = points[j].getData();
+            for (int k = 0; k < ndata; ++k) {
+                data[k] += static_cast<float>(1);
+            }
+        }
+    }
+    for (int i = 0; i < nlines; ++i) {
+        Point* points = lines[i].getPoints();
+        for (int j = 0; j < np; ++j) {
+            float* data = points[j].getData();
+            for (int k = 0; k < ndata; ++k) {
+                data[k] += static_cast<float>(i+j+k);
+            }
+        }
+    }
+    POP_RANGE
+
+    // Same two updates on the flat layout
+    PUSH_RANGE("main::kernel_flat", 2);
+    for (long p = 0; p < npts; ++p) {
+        for (int k = 0; k < ndata; ++k) {
+            flat[p * ndata + k] += static_cast<float>(1);
+        }
+    }
+    for (int i = 0; i < nlines; ++i) {
+        for (int j = 0; j < np; ++j) {
+            float* data = &flat[((long)i * np + j) * ndata];
+            for (int k = 0; k < ndata; ++k) {
+                data[k] += static_cast<float>(i+j+k);
+            }
+        }
+    }
+    POP_RANGE
+
+    // Check both layouts agree
+    double diff = 0.0;
+    for (int i = 0; i < nlines; ++i) {
+        for (int j = 0; j < np; ++j) {
+            for (int k = 0; k < ndata; ++k) {
+                diff = std::max(diff, (double)fabsf(lines[i].getPoints()[j].getData()[k] - flat[((long)i * np + j) * ndata + k]));
+            }
+        }
+    }
+    printf("%d lines x %d points x %d entries, max |objects - flat| = %e\n", nlines, np, ndata, diff);
+
+    perfReport();
+    return 0;
+}
@@ -0,0 +1,285 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Persistent thread team with lock-free dispatch and a sense-reversing barrier
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Busy-wait helper: spin briefly, then yield so oversubscribed runs still make progress
+inline void spinWait(int& spins)
+{
+    if (++spins > 1024) {
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * @brief Sense-reversing spin barrier
+ *
+ * The last thread to arrive resets the counter and flips the global sense; everybody else spins
+ * until the global sense matches its own (per-thread) sense, which is flipped on every use.
+ */
+class SpinBarrier
+{
+    private:
+        int nthreads;              // Participants
+        std::atomic<int> count;    // Threads still to arrive
+        std::atomic<bool> sense;   // Global sense
+    public:
+        explicit SpinBarrier(int n) : nthreads(n), count(n), sense(false) {}
+
+        // localSense is owned by the calling thread and must persist between calls
+        void wait(bool& localSense) {
+            localSense = !localSense;
+            if (count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                count.store(nthreads, std::memory_order_relaxed);
+                sense.store(localSense, std::memory_order_release);
+            } else {
+                int spins = 0;
+                while (sense.load(std::memory_order_acquire) != localSense) {
+                    spinWait(spins);
+                }
+            }
+        }
+};
+
+/**
+ * @brief Team of threads kept alive across parallel regions
+ *
+ * The master publishes a loop body (function pointer + context + trip count) and bumps an epoch
+ * counter with release semantics; workers spinning on the epoch pick it up without any lock.
+ * Every thread runs a static slice of the iteration space, then all meet at the barrier.
+ */
+class PersistentTeam
+{
+    private:
+        typedef void (*Invoker)(const void*, long, long);
+
+        int nthreads;                          // Team size, including the master
+        std::vector<std::thread> workers;      // Threads 1..nthreads-1
+        SpinBarrier barrier;                   // End-of-region barrier
+        std::vector<char> senses;              // Per-thread barrier sense (char: vector<bool> is packed)
+        std::atomic<long> epoch;               // Region counter (the broadcast signal)
+        std::atomic<bool> stop;                // Shutdown request
+        Invoker invoke;                        // Published body
+        const void* ctx;                       // Published body context
+        long trip;                             // Published trip count
+
+        void runSlice(int id) {
+            const long begin = trip * id / nthreads;
+            const long end = trip * (id + 1) / nthreads;
+            if (end > begin) {
+                invoke(ctx, begin, end);
+            }
+            bool s = senses[id];
+            barrier.wait(s);
+            senses[id] = s;
+        }
+
+        void workerLoop(int id) {
+            long seen = 0;
+            while (true) {
+                int spins = 0;
+                long e;
+                while ((e = epoch.load(std::memory_order_acquire)) == seen) {
+                    spinWait(spins);
+                }
+                seen = e;
+                if (stop.load(std::memory_order_acquire)) {
+                    return;
+                }
+                runSlice(id);
+            }
+        }
+
+        template <class F>
+        static void trampoline(const void* c, long begin, long end) {
+            const F& f = *static_cast<const F*>(c);
+            for (long i = begin; i < end; ++i) {
+                f(i);
+            }
+        }
+    public:
+        explicit PersistentTeam(int n) : nthreads(std::max(1, n)), barrier(std::max(1, n)), senses(std::max(1, n), 0),
+                                         epoch(0), stop(false), invoke(nullptr), ctx(nullptr), trip(0) {
+            for (int t = 1; t < nthreads; ++t) {
+                workers.emplace_back(&PersistentTeam::workerLoop, this, t);
+            }
+        }
+
+        ~PersistentTeam() {
+            stop.store(true, std::memory_order_release);
+            epoch.fetch_add(1, std::memory_order_acq_rel);
+            for (auto& w : workers) {
+                w.join();
+            }
+        }
+
+        int size() const { return nthreads; }
+
+        // Run f(i) for i in [0, n) on the team; returns when every iteration is done
+        template <class F>
+        void parallel_for(long n, const F& f) {
+            invoke = &trampoline<F>;
+            ctx = &f;
+            trip = n;
+            epoch.fetch_add(1, std::memory_order_acq_rel); // Publishes invoke/ctx/trip
+            runSlice(0);
+        }
+};
+
+// Fresh threads for every region: what a naive std::thread parallel loop costs
+template <class F>
+void freshThreadsFor(int nthreads, long n, const F& f)
+{
+    std::vector<std::thread> team;
+    for (int t = 1; t < nthreads; ++t) {
+        team.emplace_back([&, t] {
+            for (long i = n * t / nthreads; i < n * (t + 1) / nthreads; ++i) {
+                f(i);
+            }
+        });
+    }
+    for (long i = 0; i < n / nthreads; ++i) {
+        f(i);
+    }
+    for (auto& th : team) {
+        th.join();
+    }
+}
+
+// Basic class with a dynamic array (from self_instantiation)
+class Basic
+{
+    private:
+        int arrSize; // No. elements in data pointer
+        float* data; // Data pointer
+    public:
+        Basic(int size) {
+            arrSize = size;
+            data = (float*)calloc(arrSize, sizeof(float));
+        }
+        ~Basic() { free(data); }
+        int getSize() const { return arrSize; }
+        float getDataEntry(int index) const { return data[index]; }
+        void setDataEntry(int index, float value) { data[index] = value; }
+};
+
+int main(int argc, const char** argv)
+{
+    const int nthreads = (argc > 1) ? atoi(argv[1]) : (int)std::max(1u, std::thread::hardware_concurrency());
+    const int nregions = (argc > 2) ? atoi(argv[2]) : 20000; // Parallel regions per measurement
+
+    // The tiny loops of the original examples
+    Basic obj(10);                          // self_instantiation: 10 elements
+    float lines[3][3] = {{0.0f}};           // self_instantiation_adv: 3 lines x 3 points
+    float structs[10] = {0.0f};             // multiple_c_struct: NUM_OBJ = 10
+
+    auto selfInst = [&](long i) { obj.setDataEntry((int)i, obj.getDataEntry((int)i) + 1.0f); };
+    auto selfInstAdv = [&](long idx) { lines[idx / 3][idx % 3] += static_cast<float>((idx % 3) * 1.5); };
+    auto multiStruct = [&](long i) { structs[i] += 2.5f; };
+
+    int nmeasured = 0; // Measurements done, for the final check
+    auto measure = [&](const char* label, auto&& run) {
+        nmeasured += 1;
+        run(); // Warm-up
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < nregions; ++r) {
+            run();
+        }
+        const double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        printf("  %-28s %10.3f us/region\n", label, 1e6 * dt / nregions);
+    };
+
+    printf("%d threads, %d regions per measurement (3 loops per region: 10, 9 and 10 iterations)\n",
+           nthreads, nregions);
+
+    PersistentTeam team(nthreads);
+    measure("persistent team", [&] {
+        team.parallel_for(10, selfInst);
+        team.parallel_for(9, selfInstAdv);
+        team.parallel_for(10, multiStruct);
+    });
+    measure("fresh std::thread team", [&] {
+        freshThreadsFor(nthreads, 10, selfInst);
+        freshThreadsFor(nthreads, 9, selfInstAdv);
+        freshThreadsFor(nthreads, 10, multiStruct);
+    });
+#ifdef _OPENMP
+    measure("OpenMP parallel for", [&] {
+        #pragma omp parallel for num_threads(nthreads)
+        for (long i = 0; i < 10; ++i) selfInst(i);
+        #pragma omp parallel for num_threads(nthreads)
+        for (long i = 0; i < 9; ++i) selfInstAdv(i);
+        #pragma omp parallel for num_threads(nthreads)
+        for (long i = 0; i < 10; ++i) multiStruct(i);
+    });
+#else
+    printf("  %-28s %s\n", "OpenMP parallel for", "(not compiled with OpenMP)");
+#endif
+    measure("serial", [&] {
+        for (long i = 0; i < 10; ++i) selfInst(i);
+        for (long i = 0; i < 9; ++i) selfInstAdv(i);
+        for (long i = 0; i < 10; ++i) multiStruct(i);
+    });
+
+    // Every measurement ran each loop nregions+1 times (warm-up included)
+    const double expected = (double)nmeasured * (nregions + 1);
+    printf("obj[0] = %.0f (expected %.0f), structs[9] = %.1f (expected %.1f)\n",
+           obj.getDataEntry(0), expected, structs[9], 2.5 * expected);
+
+    return 0;
+}
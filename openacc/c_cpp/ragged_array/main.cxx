@@ -0,0 +1,311 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Ragged (CSR-like) container holding variable-size Point payloads in a single buffer
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Exclusive prefix sum of in[0:n] into out[0:n+1] with nthreads host threads.
+// Three phases: per-block sums, a serial scan of the block sums, then per-block scans with offsets.
+void parallelExclusiveScan(const int* in, long* out, long n, int nthreads)
+{
+    nthreads = (int)std::max(1L, std::min<long>(nthreads, n));
+    std::vector<long> blockSum(nthreads + 1, 0);
+    std::vector<std::thread> team;
+
+    auto sumBlock = [&](int t) {
+        long s = 0;
+        for (long i = n * t / nthreads; i < n * (t + 1) / nthreads; ++i) {
+            s += in[i];
+        }
+        blockSum[t + 1] = s;
+    };
+    for (int t = 1; t < nthreads; ++t) {
+        team.emplace_back(sumBlock, t);
+    }
+    sumBlock(0);
+    for (auto& th : team) {
+        th.join();
+    }
+    team.clear();
+
+    for (int t = 0; t < nthreads; ++t) {
+        blockSum[t + 1] += blockSum[t];
+    }
+
+    auto scanBlock = [&](int t) {
+        long s = blockSum[t];
+        for (long i = n * t / nthreads; i < n * (t + 1) / nthreads; ++i) {
+            out[i] = s;
+            s += in[i];
+        }
+    };
+    for (int t = 1; t < nthreads; ++t) {
+        team.emplace_back(scanBlock, t);
+    }
+    scanBlock(0);
+    for (auto& th : team) {
+        th.join();
+    }
+    out[n] = blockSum[nthreads];
+}
+
+/**
+ * @brief Variable-length segments stored back to back in one buffer, indexed by an offsets array
+ *
+ * Segment s occupies values[offsets[s] : offsets[s+1]]. Offsets and values share a single
+ * allocation, so the whole container is mirrored to the device with one transfer.
+ */
+template <class T>
+class RaggedArray
+{
+    private:
+        int nseg;      // Number of segments
+        long total;    // Total number of values
+        long bytes;    // Size of the shared buffer
+        char* buffer;  // offsets followed by values
+        long* offsets; // Segment start offsets (nseg + 1 entries), inside buffer
+        T* values;     // All segment values, inside buffer
+    public:
+        RaggedArray() : nseg(0), total(0), bytes(0), buffer(nullptr), offsets(nullptr), values(nullptr) {}
+
+        ~RaggedArray() {
+            if (buffer) {
+                #pragma acc exit data detach(offsets, values)
+                #pragma acc exit data delete(buffer[0:bytes], this[0:1])
+                free(buffer);
+            }
+        }
+
+        // Build from per-segment sizes (offsets via a parallel prefix sum), values zeroed
+        void build(const int* sizes, int n, int nthreads) {
+            nseg = n;
+            std::vector<long> off(nseg + 1);
+            parallelExclusiveScan(sizes, off.data(), nseg, nthreads);
+            total = off[nseg];
+            // Values start at an alignment suitable for T
+            const long offBytes = ((nseg + 1) * (long)sizeof(long) + alignof(T) - 1) / alignof(T) * alignof(T);
+            bytes = offBytes + total * (long)sizeof(T);
+            buffer = (char*)calloc(bytes, 1);
+            offsets = (long*)buffer;
+            values = (T*)(buffer + offBytes);
+            memcpy(offsets, off.data(), (nseg + 1) * sizeof(long));
+        }
+
+        int numSegments() const { return nseg; }
+        long numValues() const { return total; }
+        long* getOffsets() const { return offsets; }
+        T* getValues() const { return values; }
+
+        // Segment accessors (host/device callable)
+        int segmentSize(int s) const { return (int)(offsets[s + 1] - offsets[s]); }
+        T* segment(int s) const { return values + offsets[s]; }
+
+        // Segment owning flat index e (binary search on the offsets, host/device callable)
+        int segmentOf(long e) const {
+            int lo = 0, hi = nseg;
+            while (hi - lo > 1) {
+                const int mid = (lo + hi) / 2;
+                if (offsets[mid] <= e) {
+                    lo = mid;
+                } else {
+                    hi = mid;
+                }
+            }
+            return lo;
+        }
+
+        // One transfer for offsets and values, then point the device members at the device copy
+        void toDevice() {
+            PUSH_RANGE("RaggedArray::toDevice", 0);
+            #pragma acc enter data copyin(this[0:1])
+            #pragma acc enter data copyin(buffer[0:bytes])
+            #pragma acc enter data attach(offsets, values)
+            POP_RANGE
+        }
+
+        void toHost() {
+            PUSH_RANGE("RaggedArray::toHost", 1);
+            #pragma acc update self(buffer[0:bytes])
+            POP_RANGE
+        }
+
+        // Segment-parallel iteration: gang over segments, vector over their values
+        template <class F>
+        void forEachSegment(F f) {
+            const int n = nseg;
+            #pragma acc parallel loop gang present(this[0:1]) firstprivate(f)
+            for (int s = 0; s < n; ++s) {
+                T* v = values + offsets[s];
+                const int len = (int)(offsets[s + 1] - offsets[s]);
+                #pragma acc loop vector
+                for (int k = 0; k < len; ++k) {
+                    f(s, k, v[k]);
+                }
+            }
+        }
+
+        // Flat element-parallel iteration: one iteration per value, segment found by binary search
+        template <class F>
+        void forEachValue(F f) {
+            const long n = total;
+            #pragma acc parallel loop present(this[0:1]) firstprivate(f)
+            for (long e = 0; e < n; ++e) {
+                const int s = segmentOf(e);
+                f(s, (int)(e - offsets[s]), values[e]);
+            }
+        }
+};
+
+// Point class whose payload lives in a shared RaggedArray segment (its own size, no per-point allocation)
+class Point
+{
+    private:
+        int pID;  // Unique identifier for the Point, also its segment in the ragged payload
+        int kind; // Point type, which decides the number of fields
+    public:
+        int getId() const { return pID; }
+        int getKind() const { return kind; }
+        void setPoint(int id, int k) {
+            pID = id;
+            kind = k;
+        }
+        // Payload view (host/device callable)
+        int getDataSize(const RaggedArray<float>& payload) const { return payload.segmentSize(pID); }
+        float* getData(const RaggedArray<float>& payload) const { return payload.segment(pID); }
+};
+
+// Line class contains an array of Point objects sharing one ragged payload
+class Line
+{
+    private:
+        int lID;       // Unique identifier for the Line
+        int nPoints;   // Number of Point objects in this Line
+        Point* points; // Pointer to an array of Point objects
+    public:
+        int getNPoints() const { return nPoints; }
+        Point* getPoints() const { return points; }
+        void setLine(int id, int np, const int* kinds) {
+            lID = id;
+            nPoints = np;
+            points = (Point*)calloc(np, sizeof(Point));
+            for (int i = 0; i < np; ++i) {
+                points[i].setPoint(lID * np + i, kinds[lID * np + i]);
+            }
+        }
+};
+
+// Fields carried by each point type: scalar node, vector node, full state
+const int fieldsPerKind[3] = { 1, 3, 5 };
+
+int main(int argc, const char** argv)
+{
+    const int nlines = (argc > 1) ? atoi(argv[1]) : 10000; // Number of lines
+    const int np = 32;                                     // Points per line
+    const int nthreads = (int)std::max(1u, std::thread::hardware_concurrency());
+    const int npts = nlines * np;
+
+    // Point types and their payload sizes
+    std::vector<int> kinds(npts), sizes(npts);
+    for (int p = 0; p < npts; ++p) {
+        kinds[p] = (p * 7 + p / 5) % 3;
+        sizes[p] = fieldsPerKind[kinds[p]];
+    }
+
+    PUSH_RANGE("main::build", 0);
+    auto t0 = std::chrono::steady_clock::now();
+    RaggedArray<float> payload;
+    payload.build(sizes.data(), npts, nthreads);
+    auto t1 = std::chrono::steady_clock::now();
+    Line* lines = (Line*)calloc(nlines, sizeof(Line));
+    for (int i = 0; i < nlines; ++i) {
+        lines[i].setLine(i, np, kinds.data());
+    }
+    payload.toDevice();
+    POP_RANGE
+    printf("%d points, %ld payload values, offsets built in %.3f ms\n",
+           npts, payload.numValues(), 1e3 * std::chrono::duration<double>(t1 - t0).count());
+
+    // Segment-parallel update: field k of point s gets k + 1
+    PUSH_RANGE("main::segment_parallel", 1);
+    payload.forEachSegment([](int, int k, float& v) { v += static_cast<float>(k + 1); });
+    POP_RANGE
+
+    // Flat element-parallel update: every value gets its point id scaled
+    PUSH_RANGE("main::element_parallel", 2);
+    payload.forEachValue([](int s, int, float& v) { v += 1e-3f * static_cast<float>(s % 1000); });
+    POP_RANGE
+
+    payload.toHost();
+
+    // Check through the Line/Point interface
+    int errors = 0;
+    for (int i = 0; i < nlines; ++i) {
+        Point* points = lines[i].getPoints();
+        for (int j = 0; j < np; ++j) {
+            const int n = points[j].getDataSize(payload);
+            const float* data = points[j].getData(payload);
+            errors += (n != fieldsPerKind[points[j].getKind()]) ? 1 : 0;
+            for (int k = 0; k < n; ++k) {
+                const float expected = static_cast<float>(k + 1) + 1e-3f * static_cast<float>(points[j].getId() % 1000);
+                errors += (fabsf(data[k] - expected) > 1e-5f) ? 1 : 0;
+            }
+        }
+    }
+    printf("Point 0 of line 1 has %d fields: ", lines[1].getPoints()[0].getDataSize(payload));
+    for (int k = 0; k < lines[1].getPoints()[0].getDataSize(payload); ++k) {
+        printf("%f ", lines[1].getPoints()[0].getData(payload)[k]);
+    }
+    printf("\nErrors: %d\n", errors);
+
+    return 0;
+}
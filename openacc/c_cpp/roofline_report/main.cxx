@@ -0,0 +1,393 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Per-kernel bandwidth/flop accounting against an in-tree STREAM baseline
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// POSIX headers
+#include <unistd.h>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Accumulated measurements of one named kernel region
+struct RooflineRegion
+{
+    std::string name; // Region name (same as the NVTX range)
+    int calls;        // Number of executions
+    double bytes;     // Bytes moved to/from memory, summed over calls
+    double flops;     // Floating point operations, summed over calls
+    double seconds;   // Wall time, summed over calls
+};
+
+// Instrumentation registry: kernel regions declare their traffic and flops, the timer does the rest
+class Roofline
+{
+    private:
+        std::vector<RooflineRegion> regions; // Regions in order of first use
+        double peakBW;                       // Best STREAM bandwidth [B/s]
+        double copyBW;                       // STREAM copy bandwidth [B/s]
+        double triadBW;                      // STREAM triad bandwidth [B/s]
+        double updateBW;                     // In-place update bandwidth [B/s]
+        int active;                          // Region currently timed (-1 if none)
+        std::chrono::steady_clock::time_point start;
+    public:
+        bool enabled; // Instrumentation mode on/off
+
+        Roofline() : peakBW(0.0), copyBW(0.0), triadBW(0.0), updateBW(0.0), active(-1), enabled(false) {}
+
+        // STREAM-style copy and triad on device-resident arrays (best of ntimes), plus an in-place
+        // update a = s * a: copy and triad pay a hidden write-allocate on the host, read-modify-write
+        // kernels do not, so without it they could appear above the peak
+        void measureBaseline(long n, int ntimes) {
+            PUSH_RANGE("Roofline::stream", 6);
+            double* a = (double*)malloc(n * sizeof(double));
+            double* b = (double*)malloc(n * sizeof(double));
+            double* c = (double*)malloc(n * sizeof(double));
+            const double scalar = 3.0;
+            #pragma acc enter data create(a[0:n], b[0:n], c[0:n])
+            #pragma acc parallel loop present(a[0:n], b[0:n], c[0:n])
+            for (long i = 0; i < n; ++i) {
+                a[i] = 1.0;
+                b[i] = 2.0;
+                c[i] = 0.0;
+            }
+            for (int t = 0; t < ntimes; ++t) {
+                auto t0 = std::chrono::steady_clock::now();
+                #pragma acc parallel loop present(a[0:n], c[0:n])
+                for (long i = 0; i < n; ++i) {
+                    c[i] = a[i];
+                }
+                auto t1 = std::chrono::steady_clock::now();
+                #pragma acc parallel loop present(a[0:n], b[0:n], c[0:n])
+                for (long i = 0; i < n; ++i) {
+                    a[i] = b[i] + scalar * c[i];
+                }
+                auto t2 = std::chrono::steady_clock::now();
+                #pragma acc parallel loop present(b[0:n])
+                for (long i = 0; i < n; ++i) {
+                    b[i] = scalar * b[i];
+                }
+                auto t3 = std::chrono::steady_clock::now();
+                double tc = std::chrono::duration<double>(t1 - t0).count();
+                double tt = std::chrono::duration<double>(t2 - t1).count();
+                double tu = std::chrono::duration<double>(t3 - t2).count();
+                // Skip the first iteration, as STREAM does
+                if (t > 0) {
+                    copyBW = std::max(copyBW, 2.0 * sizeof(double) * n / tc);
+                    triadBW = std::max(triadBW, 3.0 * sizeof(double) * n / tt);
+                    updateBW = std::max(updateBW, 2.0 * sizeof(double) * n / tu);
+                }
+            }
+            #pragma acc exit data delete(a[0:n], b[0:n], c[0:n])
+            free(a);
+            free(b);
+            free(c);
+            peakBW = std::max(std::max(copyBW, triadBW), updateBW);
+            POP_RANGE
+        }
+
+        // Open a region declaring the bytes and flops the upcoming kernel performs
+        void begin(const char* name, double bytes, double flops) {
+            if (!enabled) {
+                return;
+            }
+            active = -1;
+            for (size_t r = 0; r < regions.size(); ++r) {
+                if (regions[r].name == name) {
+                    active = (int)r;
+                }
+            }
+            if (active < 0) {
+                regions.push_back(RooflineRegion{name, 0, 0.0, 0.0, 0.0});
+                active = (int)regions.size() - 1;
+            }
+            regions[active].calls += 1;
+            regions[active].bytes += bytes;
+            regions[active].flops += flops;
+            start = std::chrono::steady_clock::now();
+        }
+
+        // Close the open region (kernels without async are complete at this point)
+        void end() {
+            if (!enabled || active < 0) {
+                return;
+            }
+            regions[active].seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            active = -1;
+        }
+
+        void report() const {
+            if (!enabled) {
+                return;
+            }
+            printf("\nSTREAM baseline: copy %.2f GB/s, triad %.2f GB/s, update %.2f GB/s\n",
+                   copyBW * 1e-9, triadBW * 1e-9, updateBW * 1e-9);
+            printf("%-36s %6s %10s %10s %10s %8s %8s\n",
+                   "Region", "Calls", "Time[ms]", "GB/s", "GFLOP/s", "FLOP/B", "%PeakBW");
+            bool aboveDram = false;
+            for (const RooflineRegion& r : regions) {
+                const double bw = r.bytes / r.seconds;
+                // Above the STREAM peak the data came from cache: flag it instead of passing it off as DRAM bandwidth
+                const bool cached = bw > peakBW;
+                aboveDram = aboveDram || cached;
+                printf("%-36s %6d %10.3f %10.2f %10.3f %8.3f %7.1f%%%s\n",
+                       r.name.c_str(), r.calls, 1e3 * r.seconds, bw * 1e-9, r.flops / r.seconds * 1e-9,
+                       r.flops / r.bytes, 100.0 * bw / peakBW, cached ? " (*)" : "");
+            }
+            if (aboveDram) {
+                printf("(*) above the STREAM peak: the working set was (partly) cache resident, this is not DRAM bandwidth\n");
+            }
+        }
+};
+
+Roofline roofline;
+
+// Size of the last-level cache in bytes (32 MB if the system does not report it)
+long lastLevelCache()
+{
+    const long llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    return (llc > 0) ? llc : (32L << 20);
+}
+
+// Kernel region: NVTX range plus roofline accounting of the declared bytes/flops
+#define PUSH_KERNEL(name,cid,bytes,flops) PUSH_RANGE(name,cid) roofline.begin(name, bytes, flops);
+#define POP_KERNEL roofline.end(); POP_RANGE
+
+// Point class containing an id and a dynamic float array (from array_of_objects)
+class Point
+{
+    private:
+        int pID;      // Unique identifier for the Point
+        int dataSize; // Size of the data array in elements
+        float* pData; // Data pointer as a dynamic array of floats
+    public:
+        float* getData() const { return pData; }
+        void setPoint(int id, int n) {
+            this->pID = id;
+            this->dataSize = n;
+            this->pData = (float*)calloc(n, sizeof(float));
+            #pragma acc enter data copyin(pData[0:dataSize])
+        }
+};
+
+// Line class contains an array of Point objects (from array_of_objects)
+class Line
+{
+    private:
+        int lID;       // Unique identifier for the Line
+        int nPoints;   // Number of Point objects in this Line
+        Point* points; // Pointer to an array of Point objects
+    public:
+        Point* getPoints() const { return points; }
+        void setLine(int id, int np, int ndata) {
+            this->lID = id;
+            this->nPoints = np;
+            this->points = (Point*)calloc(np, sizeof(Point));
+            #pragma acc enter data copyin(points[0:nPoints])
+            for (int i = 0; i < np; ++i) {
+                points[i].setPoint(lID * np + i, ndata);
+            }
+        }
+};
+
+// Basic class with a dynamic array (from self_instantiation)
+class Basic
+{
+    private:
+        int arrSize; // No. elements in data pointer
+        float* data; // Data pointer
+    public:
+        Basic(int size) {
+            arrSize = size;
+            data = (float*)calloc(arrSize, sizeof(float));
+            #pragma acc enter data copyin(this[0:1])
+            #pragma acc enter data copyin(data[0:arrSize])
+        }
+        int getSize() const { return arrSize; }
+        void setDataEntry(int index, float value) { data[index] = value; }
+};
+
+// Simple struct containing an int and a dynamic float array (from aos_with_dynamic_arrays)
+struct BasicStruct
+{
+    int id;
+    float* value = nullptr;
+};
+
+int main(int argc, const char** argv)
+{
+    // Instrumentation mode is opt-in
+    for (int a = 1; a < argc; ++a) {
+        if (strcmp(argv[a], "--roofline") == 0) {
+            roofline.enabled = true;
+        }
+    }
+    // Every streamed working set is at least 4x the last-level cache (2x per STREAM array), so the
+    // kernels measure memory and not cache
+    const long llc = lastLevelCache();
+    if (roofline.enabled) {
+        roofline.measureBaseline(std::max(1L << 24, 2 * llc / (long)sizeof(double)), 10);
+    }
+
+    // Sizes scaled up from the original examples. The Basic and BasicStruct payloads are sized from the
+    // last-level cache like the STREAM arrays; the array_of_objects payload (16 MB) is kept small because every Point is a separate
+    // allocation, so its kernels may run from cache (flagged in the report)
+    const int np = 256;      // Points per line
+    const int ndata = 4;     // Data entries per point
+    const int nlines = 4096; // Number of lines
+    const int aSize = (int)std::max(1L << 24, 4 * llc / (long)sizeof(float)); // Basic array size
+    const int size = 4096;   // Entries per BasicStruct value array
+    const int nobj = (int)std::max(1024L, 4 * llc / (long)(size * sizeof(float))); // Number of BasicStruct objects
+    const int nrep = 5;      // Repetitions per kernel
+
+    // array_of_objects
+    Line* lines = (Line*)calloc(nlines, sizeof(Line));
+    #pragma acc enter data copyin(lines[0:nlines])
+    for (int i = 0; i < nlines; ++i) {
+        lines[i].setLine(i, np, ndata);
+    }
+    // Traffic: Line and Point objects are read for their pointers, payloads are read and written
+    const double npts = (double)nlines * np;
+    const double aooBytes = nlines * sizeof(Line) + npts * sizeof(Point) + 2.0 * npts * ndata * sizeof(float);
+    for (int r = 0; r < nrep; ++r) {
+        PUSH_KERNEL("main::kernel_1", 0, aooBytes, npts * ndata);
+        #pragma acc parallel loop present(lines[0:nlines])
+        for (int i = 0; i < nlines; ++i) {
+            Point* points = lines[i].getPoints();
+            #pragma acc loop
+            for (int j = 0; j < np; ++j) {
+                float* data = points[j].getData();
+                for (int k = 0; k < ndata; ++k) {
+                    data[k] += static_cast<float>(1);
+                }
+            }
+        }
+        POP_KERNEL
+
+        PUSH_KERNEL("main::kernel_2", 0, aooBytes, npts * ndata);
+        #pragma acc parallel loop gang present(lines[0:nlines])
+        for (int i = 0; i < nlines; ++i) {
+            Point* points = lines[i].getPoints();
+            #pragma acc loop vector
+            for (int j = 0; j < np; ++j) {
+                float* data = points[j].getData();
+                #pragma acc loop seq
+                for (int k = 0; k < ndata; ++k) {
+                    data[k] += static_cast<float>(i+j+k);
+                }
+            }
+        }
+        POP_KERNEL
+    }
+
+    // self_instantiation: write-only loops through a device-resident object
+    Basic obj(aSize);
+    for (int r = 0; r < nrep; ++r) {
+        PUSH_KERNEL("Main::first_parallel_loop", 0, (double)aSize * sizeof(float), 0.0);
+        #pragma acc parallel loop present(obj)
+        for (int i = 0; i < obj.getSize(); i++) {
+            float value = static_cast<float>(i+1);
+            obj.setDataEntry(i, value);
+        }
+        POP_KERNEL
+
+        PUSH_KERNEL("Main::second_parallel_loop", 1, (double)aSize * sizeof(float), 0.0);
+        #pragma acc parallel loop present(obj)
+        for (int i = 0; i < obj.getSize(); i++) {
+            float value = static_cast<float>(i+2);
+            obj.setDataEntry(i, value);
+        }
+        POP_KERNEL
+    }
+
+    // aos_with_dynamic_arrays
+    BasicStruct* d_struc = (BasicStruct*)malloc(nobj * sizeof(BasicStruct));
+    for (int i = 0; i < nobj; i++) {
+        d_struc[i].id = 0;
+        d_struc[i].value = (float*)calloc(size, sizeof(float));
+    }
+    #pragma acc enter data copyin(d_struc[0:nobj])
+    for (int i = 0; i < nobj; i++) {
+        #pragma acc enter data copyin(d_struc[i].value[0:size])
+    }
+    const double nval = (double)nobj * size;
+    for (int r = 0; r < nrep; ++r) {
+        // Kernel 1 only writes the values (plus the struct array read/write)
+        PUSH_KERNEL("aos::kernel_1", 2, 2.0 * nobj * sizeof(BasicStruct) + nval * sizeof(float), 2.0 * nval);
+        #pragma acc parallel loop gang present(d_struc[0:nobj])
+        for (int i = 0; i < nobj; i++) {
+            d_struc[i].id = i+1;
+            #pragma acc loop vector
+            for (int j = 0; j < size; j++) {
+                d_struc[i].value[j] = 2.0f + (float) j + (float) i;
+            }
+        }
+        POP_KERNEL
+
+        PUSH_KERNEL("aos::kernel_2", 3, 2.0 * nobj * sizeof(BasicStruct) + 2.0 * nval * sizeof(float), nval);
+        #pragma acc parallel loop gang present(d_struc[0:nobj])
+        for (int i = 0; i < nobj; i++) {
+            d_struc[i].id -= 1;
+            #pragma acc loop vector
+            for (int j = 0; j < size; j++) {
+                d_struc[i].value[j] *= 2.0f;
+            }
+        }
+        POP_KERNEL
+    }
+
+    roofline.report();
+    if (!roofline.enabled) {
+        printf("Kernels done. Run with --roofline for the bandwidth report.\n");
+    }
+
+    return 0;
+}
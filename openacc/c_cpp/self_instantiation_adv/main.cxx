@@ -10,6 +10,7 @@
  */
 
 // C headers
+#include <cassert>
 #include <cstdlib>
 #include <cstdint>
 #include <cstdio>
@@ -121,6 +122,18 @@ class Point
     }
 };
 
+// Quadrature table on [-1, 1] (as in gauss_quadrature)
+template <int N>
+struct QuadTable
+{
+    double x[N];
+    double w[N];
+};
+
+// 2-point Gauss-Legendre rule as a compile-time constant: no per-element setup at run time
+// See gauss_quadrature for tables of any order generated by the compiler
+constexpr QuadTable<2> gaussLegendre2 = { { -0.5773502691896257, 0.5773502691896257 }, { 1.0, 1.0 } };
+
 // Child GaussPoint class, derived from Point
 class GaussPoint : public Point
 {
@@ -144,6 +157,14 @@ class GaussPoint : public Point
             gpWeight = weight;
         }
 
+        // Same, also placing the point at x in the reference element [-1, 1]
+        void setGaussPoint(int id, int size, float x, float weight) {
+            this->setPoint(id, size);
+            this->setPointCoords(x, 0.0f, 0.0f);
+            #pragma acc update device(xyz[0:3])
+            gpWeight = weight;
+        }
+
         void setGaussPointWeight(float weight) {
             gpWeight = weight;
         }
@@ -187,6 +208,7 @@ class Line
             lineID = id;
             numPoints = np;
             numGaussPoints = ngp;
+            assert(ngp == 2 && "Gauss points are set from the 2-point Gauss-Legendre table");
 
             // Copy the Line object to device using self-referencing
             PUSH_RANGE("Line::constructor_copy_this", 0);
@@ -216,7 +238,7 @@ class Line
             // Fill up the GaussPoint objects
             PUSH_RANGE("Line::constructor_fill_gaussPoints", 0);
             for (int i = 0; i < numGaussPoints; ++i) {
-                gaussPoints[i].setGaussPoint(i, 5, 0.577f); // Each Gauss point has 5 data entries and a weight
+                gaussPoints[i].setGaussPoint(i, 5, (float)gaussLegendre2.x[i], (float)gaussLegendre2.w[i]); // Each Gauss point has 5 data entries, its position and weight
             }
             POP_RANGE
         }
@@ -232,6 +254,7 @@ class Line
             lineID = id;
             numPoints = np;
             numGaussPoints = ngp;
+            assert(ngp == 2 && "Gauss points are set from the 2-point Gauss-Legendre table");
 
             PUSH_RANGE("Line::setLine_copy_this", 0);
             #pragma acc enter data copyin(this[0:1])
@@ -250,7 +273,7 @@ class Line
             // Fill up the GaussPoint objects
             PUSH_RANGE("Line::setLine_fill_gaussPoints", 0);
             for (int i = 0; i < numGaussPoints; ++i) {
-                gaussPoints[i].setGaussPoint(i, 5, 0.577f); // Each Gauss point has 5 data entries and a weight
+                gaussPoints[i].setGaussPoint(i, 5, (float)gaussLegendre2.x[i], (float)gaussLegendre2.w[i]); // Each Gauss point has 5 data entries, its position and weight
             }
             POP_RANGE
 
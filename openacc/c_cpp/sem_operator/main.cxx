@@ -0,0 +1,698 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Matrix-free sum-factorization mass and Laplacian operators for spectral-element Lines and Quads
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// constexpr math helpers (std::cos and std::fabs are not constexpr in C++20)
+constexpr double cxPi = 3.14159265358979323846;
+
+constexpr double cxAbs(double x) { return x < 0.0 ? -x : x; }
+
+constexpr double cxCos(double x)
+{
+    double term = 1.0, sum = 1.0;
+    for (int k = 1; k < 40; ++k) {
+        term *= -x * x / ((2.0 * k - 1.0) * (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// Legendre polynomial P_n(x) and its derivative
+constexpr void legendre(int n, double x, double& p, double& dp)
+{
+    double p0 = 1.0, p1 = x;
+    for (int k = 2; k <= n; ++k) {
+        const double p2 = ((2.0 * k - 1.0) * x * p1 - (k - 1.0) * p0) / k;
+        p0 = p1;
+        p1 = p2;
+    }
+    p = (n == 0) ? 1.0 : p1;
+    dp = (n == 0) ? 0.0 : n * (x * p1 - p0) / (x * x - 1.0);
+}
+
+// Gauss-Legendre points and weights (see gauss_quadrature)
+constexpr void gaussLegendre(int n, double* x, double* w)
+{
+    for (int i = 0; i < n; ++i) {
+        double xi = -cxCos(cxPi * (i + 0.75) / (n + 0.5));
+        double p = 0.0, dp = 1.0;
+        for (int it = 0; it < 100; ++it) {
+            legendre(n, xi, p, dp);
+            xi -= p / dp;
+            if (cxAbs(p / dp) < 1e-16) {
+                break;
+            }
+        }
+        legendre(n, xi, p, dp);
+        x[i] = xi;
+        w[i] = 2.0 / ((1.0 - xi * xi) * dp * dp);
+    }
+}
+
+// Gauss-Lobatto points (the element nodes)
+constexpr void gaussLobattoPoints(int n, double* x)
+{
+    const int m = n - 1;
+    x[0] = -1.0;
+    x[m] = 1.0;
+    for (int i = 1; i < m; ++i) {
+        double xi = -cxCos(cxPi * i / m);
+        double p = 0.0, dp = 0.0;
+        for (int it = 0; it < 100; ++it) {
+            legendre(m, xi, p, dp);
+            const double dx = dp / ((2.0 * xi * dp - m * (m + 1.0) * p) / (1.0 - xi * xi));
+            xi -= dx;
+            if (cxAbs(dx) < 1e-16) {
+                break;
+            }
+        }
+        x[i] = xi;
+    }
+}
+
+/**
+ * @brief 1D basis of order P: Lagrange polynomials on the N = P + 1 Gauss-Lobatto nodes,
+ * evaluated (B) and differentiated (D) at Q = P + 2 Gauss-Legendre points
+ *
+ * Q = P + 2 integrates the mass matrix of the affine element exactly. Everything is constexpr.
+ */
+template <int P>
+struct Basis
+{
+    static constexpr int N = P + 1;
+    static constexpr int Q = P + 2;
+    double xn[N];   // Nodes on [-1, 1]
+    double xq[Q];   // Quadrature points
+    double w[Q];    // Quadrature weights
+    double B[Q][N]; // l_j(xq_i)
+    double D[Q][N]; // l_j'(xq_i)
+
+    constexpr Basis() : xn{}, xq{}, w{}, B{}, D{} {
+        gaussLobattoPoints(N, xn);
+        gaussLegendre(Q, xq, w);
+        for (int i = 0; i < Q; ++i) {
+            for (int j = 0; j < N; ++j) {
+                double l = 1.0, dl = 0.0;
+                for (int m = 0; m < N; ++m) {
+                    if (m == j) {
+                        continue;
+                    }
+                    // Product rule: dl accumulates the derivative of the running product
+                    dl = dl * (xq[i] - xn[m]) / (xn[j] - xn[m]) + l / (xn[j] - xn[m]);
+                    l *= (xq[i] - xn[m]) / (xn[j] - xn[m]);
+                }
+                B[i][j] = l;
+                D[i][j] = dl;
+            }
+        }
+    }
+};
+
+// Point class: a node of the mesh
+class Point
+{
+    private:
+        int pID;  // Global node ID
+        double x; // Coordinate along the line
+    public:
+        void setPoint(int id, double xc) {
+            pID = id;
+            x = xc;
+        }
+        int getId() const { return pID; }
+        double getX() const { return x; }
+};
+
+// Line element of order P: N = P + 1 Gauss-Lobatto nodes, the end nodes shared with the neighbours
+template <int P>
+class Line
+{
+    private:
+        int lID;
+        Point points[P + 1];
+    public:
+        void setLine(int id, double x0, double x1) {
+            constexpr Basis<P> basis;
+            lID = id;
+            for (int i = 0; i <= P; ++i) {
+                points[i].setPoint(id * P + i, x0 + 0.5 * (basis.xn[i] + 1.0) * (x1 - x0));
+            }
+        }
+        double length() const { return points[P].getX() - points[0].getX(); }
+        int nodeId(int i) const { return points[i].getId(); }
+};
+
+/**
+ * @brief Structured mesh of spectral elements: Lines (DIM = 1) or Quads (DIM = 2), the latter being
+ * the tensor product of a Line in x and a Line in y
+ *
+ * Elements are processed in batches of V, stored element-innermost (u[dof][lane]), so every
+ * sum-factorization contraction is a loop over V independent lanes that the compiler vectorizes.
+ */
+template <int P, int DIM>
+class SemMesh
+{
+    public:
+        static constexpr int N = P + 1;
+        static constexpr int Q = P + 2;
+        static constexpr int NY = (DIM == 2) ? N : 1;  // Nodes per element along y
+        static constexpr int QY = (DIM == 2) ? Q : 1;  // Quadrature points along y
+        static constexpr int NE = N * NY;              // Nodes per element
+        static constexpr int V = 8;                    // Elements per SIMD batch
+    private:
+        int nelx, nely;        // Elements per direction
+        int ngx, ngy;          // Global nodes per direction
+        int nelem, nbatch;
+        Line<P>* linesX;       // Elements along x
+        Line<P>* linesY;       // Elements along y (a single dummy line for DIM = 1)
+        int* elemNodes;        // Global node of local node k of element e: [batch][k][lane]
+        double* geoMass;       // Jacobian per element: [batch][lane]
+        double* geoX;          // Laplacian x factor per element
+        double* geoY;          // Laplacian y factor per element
+    public:
+        SemMesh(int nx, int ny) {
+            nelx = nx;
+            nely = (DIM == 2) ? ny : 1;
+            ngx = nelx * P + 1;
+            ngy = (DIM == 2) ? nely * P + 1 : 1;
+            nelem = nelx * nely;
+            nbatch = (nelem + V - 1) / V;
+
+            linesX = new Line<P>[nelx];
+            linesY = new Line<P>[nely];
+            for (int i = 0; i < nelx; ++i) {
+                linesX[i].setLine(i, (double)i / nelx, (double)(i + 1) / nelx);
+            }
+            for (int j = 0; j < nely; ++j) {
+                linesY[j].setLine(j, (double)j / nely, (double)(j + 1) / nely);
+            }
+
+            // Connectivity and geometric factors, batched; padding lanes repeat the last element with zero factors
+            elemNodes = (int*)calloc((size_t)nbatch * NE * V, sizeof(int));
+            geoMass = (double*)calloc((size_t)nbatch * V, sizeof(double));
+            geoX = (double*)calloc((size_t)nbatch * V, sizeof(double));
+            geoY = (double*)calloc((size_t)nbatch * V, sizeof(double));
+            for (int b = 0; b < nbatch; ++b) {
+                for (int l = 0; l < V; ++l) {
+                    const int e = std::min(b * V + l, nelem - 1);
+                    const Line<P>& lx = linesX[e % nelx];
+                    const Line<P>& ly = linesY[e / nelx];
+                    for (int iy = 0; iy < NY; ++iy) {
+                        for (int ix = 0; ix < N; ++ix) {
+                            const int gy = (DIM == 2) ? ly.nodeId(iy) : 0;
+                            elemNodes[((size_t)b * NE + iy * N + ix) * V + l] = gy * ngx + lx.nodeId(ix);
+                        }
+                    }
+                    if (b * V + l < nelem) {
+                        const double hx = lx.length(), hy = (DIM == 2) ? ly.length() : 2.0;
+                        geoMass[b * V + l] = 0.25 * hx * hy;
+                        geoX[b * V + l] = hy / hx;
+                        geoY[b * V + l] = hx / hy;
+                    }
+                }
+            }
+            #pragma acc enter data copyin(this[0:1])
+            #pragma acc enter data copyin(elemNodes[0:(size_t)nbatch*NE*V], geoMass[0:nbatch*V], geoX[0:nbatch*V], geoY[0:nbatch*V])
+        }
+
+        ~SemMesh() {
+            #pragma acc exit data delete(elemNodes[0:(size_t)nbatch*NE*V], geoMass[0:nbatch*V], geoX[0:nbatch*V], geoY[0:nbatch*V], this[0:1])
+            free(elemNodes);
+            free(geoMass);
+            free(geoX);
+            free(geoY);
+            delete[] linesX;
+            delete[] linesY;
+        }
+
+        int numDofs() const { return ngx * ngy; }
+        int numElements() const { return nelem; }
+        int numGlobalX() const { return ngx; }
+        int numGlobalY() const { return ngy; }
+        int elementsX() const { return nelx; }
+        int elementsY() const { return nely; }
+
+        /**
+         * @brief Element operator on one batch: y = M u (laplace = false) or y = K u (laplace = true)
+         *
+         * 2D costs O(N^3) per element through four (mass) or eight (Laplacian) 1D contractions,
+         * instead of O(N^4) for a dense element matrix.
+         */
+        template <bool LAPLACE>
+        static void applyBatch(const double* __restrict u, double* __restrict y,
+                               double gm[V], double gx[V], double gyf[V])
+        {
+            constexpr Basis<P> bs;
+            if constexpr (DIM == 1) {
+                double t[Q][V];
+                for (int q = 0; q < Q; ++q) {
+                    for (int l = 0; l < V; ++l) {
+                        t[q][l] = 0.0;
+                    }
+                    for (int i = 0; i < N; ++i) {
+                        const double c = LAPLACE ? bs.D[q][i] : bs.B[q][i];
+                        for (int l = 0; l < V; ++l) {
+                            t[q][l] += c * u[i * V + l];
+                        }
+                    }
+                    for (int l = 0; l < V; ++l) {
+                        // 1D: geoMass holds the Jacobian h/2 and geoX the Laplacian factor 2/h
+                        t[q][l] *= bs.w[q] * (LAPLACE ? gx[l] : gm[l]);
+                    }
+                }
+                for (int i = 0; i < N; ++i) {
+                    for (int l = 0; l < V; ++l) {
+                        y[i * V + l] = 0.0;
+                    }
+                    for (int q = 0; q < Q; ++q) {
+                        const double c = LAPLACE ? bs.D[q][i] : bs.B[q][i];
+                        for (int l = 0; l < V; ++l) {
+                            y[i * V + l] += c * t[q][l];
+                        }
+                    }
+                }
+            } else if constexpr (!LAPLACE) {
+                double t1[N][Q][V], t2[Q][Q][V];
+                // Interpolate along x, then y
+                for (int iy = 0; iy < N; ++iy) {
+                    for (int qx = 0; qx < Q; ++qx) {
+                        double s[V] = {};
+                        for (int ix = 0; ix < N; ++ix) {
+                            for (int l = 0; l < V; ++l) {
+                                s[l] += bs.B[qx][ix] * u[(iy * N + ix) * V + l];
+                            }
+                        }
+                        for (int l = 0; l < V; ++l) {
+                            t1[iy][qx][l] = s[l];
+                        }
+                    }
+                }
+                for (int qy = 0; qy < Q; ++qy) {
+                    for (int qx = 0; qx < Q; ++qx) {
+                        double s[V] = {};
+                        for (int iy = 0; iy < N; ++iy) {
+                            for (int l = 0; l < V; ++l) {
+                                s[l] += bs.B[qy][iy] * t1[iy][qx][l];
+                            }
+                        }
+                        for (int l = 0; l < V; ++l) {
+                            t2[qy][qx][l] = s[l] * bs.w[qx] * bs.w[qy] * gm[l];
+                        }
+                    }
+                }
+                // Transposed contractions back to the nodes
+                for (int iy = 0; iy < N; ++iy) {
+                    for (int qx = 0; qx < Q; ++qx) {
+                        double s[V] = {};
+                        for (int qy = 0; qy < Q; ++qy) {
+                            for (int l = 0; l < V; ++l) {
+                                s[l] += bs.B[qy][iy] * t2[qy][qx][l];
+                            }
+                        }
+                        for (int l = 0; l < V; ++l) {
+                            t1[iy][qx][l] = s[l];
+                        }
+                    }
+                }
+                for (int iy = 0; iy < N; ++iy) {
+                    for (int ix = 0; ix < N; ++ix) {
+                        double s[V] = {};
+                        for (int qx = 0; qx < Q; ++qx) {
+                            for (int l = 0; l < V; ++l) {
+                                s[l] += bs.B[qx][ix] * t1[iy][qx][l];
+                            }
+                        }
+                        for (int l = 0; l < V; ++l) {
+                            y[(iy * N + ix) * V + l] = s[l];
+                        }
+                    }
+                }
+            } else {
+                double a1[N][Q][V], a2[N][Q][V], gxq[Q][Q][V], gyq[Q][Q][V];
+                // a1 = B_x u, a2 = D_x u
+                for (int iy = 0; iy < N; ++iy) {
+                    for (int qx = 0; qx < Q; ++qx) {
+                        double s1[V] = {}, s2[V] = {};
+                        for (int ix = 0; ix < N; ++ix) {
+                            for (int l = 0; l < V; ++l) {
+                                s1[l] += bs.B[qx][ix] * u[(iy * N + ix) * V + l];
+                                s2[l] += bs.D[qx][ix] * u[(iy * N + ix) * V + l];
+                            }
+                        }
+                        for (int l = 0; l < V; ++l) {
+                            a1[iy][qx][l] = s1[l];
+                            a2[iy][qx][l] = s2[l];
+                        }
+                    }
+                }
+                // Reference gradients at the quadrature points, scaled by weights and geometry
+                for (int qy = 0; qy < Q; ++qy) {
+                    for (int qx = 0; qx < Q; ++qx) {
+                        double sx[V] = {}, sy[V] = {};
+                        for (int iy = 0; iy < N; ++iy) {
+                            for (int l = 0; l < V; ++l) {
+                                sx[l] += bs.B[qy][iy] * a2[iy][qx][l];
+                                sy[l] += bs.D[qy][iy] * a1[iy][qx][l];
+                            }
+                        }
+                        const double wq = bs.w[qx] * bs.w[qy];
+                        for (int l = 0; l < V; ++l) {
+                            gxq[qy][qx][l] = sx[l] * wq * gx[l];
+                            gyq[qy][qx][l] = sy[l] * wq * gyf[l];
+                        }
+                    }
+                }
+                // a2 = B_y^T gx, a1 = D_y^T gy
+                for (int iy = 0; iy < N; ++iy) {
+                    for (int qx = 0; qx < Q; ++qx) {
+                        double s1[V] = {}, s2[V] = {};
+                        for (int qy = 0; qy < Q; ++qy) {
+                            for (int l = 0; l < V; ++l) {
+                                s2[l] += bs.B[qy][iy] * gxq[qy][qx][l];
+                                s1[l] += bs.D[qy][iy] * gyq[qy][qx][l];
+                            }
+                        }
+                        for (int l = 0; l < V; ++l) {
+                            a1[iy][qx][l] = s1[l];
+                            a2[iy][qx][l] = s2[l];
+                        }
+                    }
+                }
+                // y = D_x^T a2 + B_x^T a1
+                for (int iy = 0; iy < N; ++iy) {
+                    for (int ix = 0; ix < N; ++ix) {
+                        double s[V] = {};
+                        for (int qx = 0; qx < Q; ++qx) {
+                            for (int l = 0; l < V; ++l) {
+                                s[l] += bs.D[qx][ix] * a2[iy][qx][l] + bs.B[qx][ix] * a1[iy][qx][l];
+                            }
+                        }
+                        for (int l = 0; l < V; ++l) {
+                            y[(iy * N + ix) * V + l] = s[l];
+                        }
+                    }
+                }
+            }
+        }
+
+        // Global matrix-free apply: gather each batch, apply the element operator, scatter-add
+        template <bool LAPLACE>
+        void apply(const double* u, double* y) const
+        {
+            const int ndof = numDofs();
+            const int nb = nbatch;
+            const int ne = nelem;
+            const int* en = elemNodes;
+            const double* gmAll = geoMass;
+            const double* gxAll = geoX;
+            const double* gyAll = geoY;
+            #pragma acc parallel loop present(y[0:ndof])
+            for (int i = 0; i < ndof; ++i) {
+                y[i] = 0.0;
+            }
+            #pragma acc parallel loop gang present(u[0:ndof], y[0:ndof], en[0:(size_t)nb*NE*V], gmAll[0:nb*V], gxAll[0:nb*V], gyAll[0:nb*V])
+            for (int b = 0; b < nb; ++b) {
+                double ul[NE * V], yl[NE * V];
+                double gm[V], gx[V], gy[V];
+                for (int l = 0; l < V; ++l) {
+                    gm[l] = gmAll[b * V + l];
+                    gx[l] = gxAll[b * V + l];
+                    gy[l] = gyAll[b * V + l];
+                }
+                for (int k = 0; k < NE * V; ++k) {
+                    ul[k] = u[en[(size_t)b * NE * V + k]];
+                }
+                applyBatch<LAPLACE>(ul, yl, gm, gx, gy);
+                // Padding lanes have zero geometric factors, so they add nothing
+                const int nlanes = std::min(V, ne - b * V);
+                for (int k = 0; k < NE; ++k) {
+                    for (int l = 0; l < nlanes; ++l) {
+                        #pragma acc atomic update
+                        y[en[((size_t)b * NE + k) * V + l]] += yl[k * V + l];
+                    }
+                }
+            }
+        }
+
+        // Dense element matrix of the first element, by applying the operator to unit vectors
+        template <bool LAPLACE>
+        std::vector<double> elementMatrix() const
+        {
+            std::vector<double> A(NE * NE);
+            double ul[NE * V], yl[NE * V];
+            double gm[V], gx[V], gy[V];
+            for (int l = 0; l < V; ++l) {
+                gm[l] = geoMass[0];
+                gx[l] = geoX[0];
+                gy[l] = geoY[0];
+            }
+            for (int j = 0; j < NE; ++j) {
+                for (int k = 0; k < NE * V; ++k) {
+                    ul[k] = (k / V == j) ? 1.0 : 0.0;
+                }
+                applyBatch<LAPLACE>(ul, yl, gm, gx, gy);
+                for (int i = 0; i < NE; ++i) {
+                    A[i * NE + j] = yl[i * V];
+                }
+            }
+            return A;
+        }
+};
+
+/**
+ * @brief Assembled baseline: the same operator as a global CSR matrix
+ *
+ * On the structured mesh, the nodes coupled to a node form a rectangle (the union of the
+ * elements containing it), so the column pattern is built directly and the element matrices
+ * are added in place. The mesh is uniform, so one element matrix serves every element.
+ */
+struct CsrMatrix
+{
+    int nrows;
+    long nnz;
+    long* rowPtr;
+    int* cols;
+    double* vals;
+
+    template <int P, int DIM, bool LAPLACE>
+    void assemble(const SemMesh<P, DIM>& mesh) {
+        using Mesh = SemMesh<P, DIM>;
+        const int ngx = mesh.numGlobalX(), ngy = mesh.numGlobalY();
+        const int nelx = mesh.elementsX(), nely = mesh.elementsY();
+        nrows = mesh.numDofs();
+        rowPtr = (long*)calloc(nrows + 1, sizeof(long));
+        std::vector<int> x0(ngx), wx(ngx), y0(ngy), wy(ngy);
+        // Column range per direction: from the first node of the leftmost element to the last of the rightmost
+        auto range = [](int g, int nel, int& lo, int& width) {
+            const int eLo = std::max(0, (g - 1) / P), eHi = std::min(nel - 1, g / P);
+            lo = eLo * P;
+            width = (eHi + 1) * P - lo + 1;
+        };
+        for (int g = 0; g < ngx; ++g) {
+            range(g, nelx, x0[g], wx[g]);
+        }
+        for (int g = 0; g < ngy; ++g) {
+            if (DIM == 2) {
+                range(g, nely, y0[g], wy[g]);
+            } else {
+                y0[g] = 0;
+                wy[g] = 1;
+            }
+        }
+        for (int r = 0; r < nrows; ++r) {
+            rowPtr[r + 1] = rowPtr[r] + (long)wx[r % ngx] * wy[r / ngx];
+        }
+        nnz = rowPtr[nrows];
+        cols = (int*)malloc(nnz * sizeof(int));
+        vals = (double*)calloc(nnz, sizeof(double));
+        for (int r = 0; r < nrows; ++r) {
+            const int gx = r % ngx, gy = r / ngx;
+            long k = rowPtr[r];
+            for (int cy = y0[gy]; cy < y0[gy] + wy[gy]; ++cy) {
+                for (int cx = x0[gx]; cx < x0[gx] + wx[gx]; ++cx) {
+                    cols[k++] = cy * ngx + cx;
+                }
+            }
+        }
+
+        const std::vector<double> Ae = mesh.template elementMatrix<LAPLACE>();
+        for (int ey = 0; ey < nely; ++ey) {
+            for (int ex = 0; ex < nelx; ++ex) {
+                for (int i = 0; i < Mesh::NE; ++i) {
+                    const int rx = ex * P + i % Mesh::N, ry = ey * P + i / Mesh::N;
+                    const int r = ry * ngx + rx;
+                    for (int j = 0; j < Mesh::NE; ++j) {
+                        const int cx = ex * P + j % Mesh::N, cy = ey * P + j / Mesh::N;
+                        vals[rowPtr[r] + (long)(cy - y0[ry]) * wx[rx] + (cx - x0[rx])] += Ae[i * Mesh::NE + j];
+                    }
+                }
+            }
+        }
+        #pragma acc enter data copyin(rowPtr[0:nrows+1], cols[0:nnz], vals[0:nnz])
+    }
+
+    void release() {
+        #pragma acc exit data delete(rowPtr[0:nrows+1], cols[0:nnz], vals[0:nnz])
+        free(rowPtr);
+        free(cols);
+        free(vals);
+    }
+
+    void spmv(const double* x, double* y) const {
+        const int n = nrows;
+        const long* rp = rowPtr;
+        const int* c = cols;
+        const double* v = vals;
+        #pragma acc parallel loop present(rp[0:n+1], c[0:nnz], v[0:nnz], x[0:n], y[0:n])
+        for (int r = 0; r < n; ++r) {
+            double s = 0.0;
+            for (long k = rp[r]; k < rp[r + 1]; ++k) {
+                s += v[k] * x[c[k]];
+            }
+            y[r] = s;
+        }
+    }
+};
+
+template <class F>
+double timeIt(int nrep, F f)
+{
+    f();
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < nrep; ++r) {
+        f();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() / nrep;
+}
+
+template <int P, int DIM, bool LAPLACE>
+void benchmark(int targetDofs, int nrep)
+{
+    // Elements per direction for roughly targetDofs global nodes
+    const int nel = std::max(1, (DIM == 2) ? (int)(std::sqrt((double)targetDofs) / P) : targetDofs / P);
+    SemMesh<P, DIM> mesh(nel, nel);
+    const int ndof = mesh.numDofs();
+
+    double* u = (double*)malloc(ndof * sizeof(double));
+    double* yMf = (double*)malloc(ndof * sizeof(double));
+    double* yAs = (double*)malloc(ndof * sizeof(double));
+    const int ngx = mesh.numGlobalX();
+    for (int i = 0; i < ndof; ++i) {
+        const double x = (double)(i % ngx) / (ngx - 1), y = (double)(i / ngx) / std::max(1, mesh.numGlobalY() - 1);
+        u[i] = std::sin(3.0 * x) * std::cos(2.0 * y);
+    }
+    #pragma acc enter data copyin(u[0:ndof]) create(yMf[0:ndof], yAs[0:ndof])
+
+    CsrMatrix A;
+    A.assemble<P, DIM, LAPLACE>(mesh);
+
+    PUSH_RANGE(LAPLACE ? "matrix_free::laplace" : "matrix_free::mass", 0);
+    const double tMf = timeIt(nrep, [&] { mesh.template apply<LAPLACE>(u, yMf); });
+    POP_RANGE
+    PUSH_RANGE(LAPLACE ? "assembled::laplace" : "assembled::mass", 1);
+    const double tAs = timeIt(nrep, [&] { A.spmv(u, yAs); });
+    POP_RANGE
+
+    #pragma acc update self(yMf[0:ndof], yAs[0:ndof])
+    double diff = 0.0, ref = 0.0, sum = 0.0;
+    for (int i = 0; i < ndof; ++i) {
+        diff = std::max(diff, std::fabs(yMf[i] - yAs[i]));
+        ref = std::max(ref, std::fabs(yAs[i]));
+    }
+    // Check with u = x on the unit square/line: u^T M u = 1/3 and u^T K u = 1
+    for (int i = 0; i < ndof; ++i) {
+        u[i] = 0.0;
+    }
+    constexpr Basis<P> bs;
+    for (int ex = 0; ex < nel; ++ex) {
+        for (int i = 0; i <= P; ++i) {
+            for (int gy = 0; gy < mesh.numGlobalY(); ++gy) {
+                u[gy * ngx + ex * P + i] = (double)ex / nel + 0.5 * (bs.xn[i] + 1.0) / nel;
+            }
+        }
+    }
+    #pragma acc update device(u[0:ndof])
+    mesh.template apply<LAPLACE>(u, yMf);
+    #pragma acc update self(yMf[0:ndof])
+    for (int i = 0; i < ndof; ++i) {
+        sum += u[i] * yMf[i];
+    }
+
+    printf("%dD P=%d %-7s | %9d dofs | matrix-free %8.2f MDoF/s | assembled %8.2f MDoF/s (%5.1f nnz/row, %6.1f MB) | speedup %5.2fx | rel. diff %.1e | u^T op u = %.12f\n",
+           DIM, P, LAPLACE ? "laplace" : "mass", ndof, 1e-6 * ndof / tMf, 1e-6 * ndof / tAs, (double)A.nnz / ndof,
+           1e-6 * (A.nnz * 12.0 + (ndof + 1) * 8.0), tAs / tMf, diff / ref, sum);
+
+    #pragma acc exit data delete(u[0:ndof], yMf[0:ndof], yAs[0:ndof])
+    A.release();
+    free(u);
+    free(yMf);
+    free(yAs);
+}
+
+int main(int argc, const char** argv)
+{
+    const int targetDofs = (argc > 1) ? atoi(argv[1]) : 100000; // Approximate number of global nodes
+    const int nrep = (argc > 2) ? atoi(argv[2]) : 10;           // Timed repetitions
+
+    benchmark<4, 1, false>(targetDofs, nrep);
+    benchmark<4, 1, true>(targetDofs, nrep);
+    benchmark<2, 2, false>(targetDofs, nrep);
+    benchmark<2, 2, true>(targetDofs, nrep);
+    benchmark<4, 2, false>(targetDofs, nrep);
+    benchmark<4, 2, true>(targetDofs, nrep);
+    benchmark<7, 2, false>(targetDofs, nrep);
+    benchmark<7, 2, true>(targetDofs, nrep);
+
+    return 0;
+}
@@ -0,0 +1,444 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Compile-time polymorphism (CRTP) for point/element kinds stored in type-sorted buckets
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cassert>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <tuple>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Data entries per point (fixed, so every kind is trivially copyable)
+#define NDATA 4
+
+// CRTP base for every point kind: common attributes, statically dispatched behaviour
+template <class Kind>
+class PointBase
+{
+    protected:
+        int pID;           // Point ID
+        float xyz[3];      // Coordinates in 3D
+        float data[NDATA]; // Data field array
+    public:
+        // Set the common attributes (host only)
+        void setPoint(int id, float x) {
+            pID = id;
+            xyz[0] = x;
+            xyz[1] = 0.0f;
+            xyz[2] = 0.0f;
+            for (int k = 0; k < NDATA; ++k) {
+                data[k] = 0.0f;
+            }
+        }
+
+        // Getters (host/device callable)
+        int getId() const { return pID; }
+        float getX() const { return xyz[0]; }
+        float getDataEntry(int k) const { return data[k]; }
+
+        // Update resolved at compile time into Kind::updateImpl (host/device callable)
+        void update(float t) {
+            static_cast<Kind*>(this)->updateImpl(t);
+        }
+
+        // Printer resolved at compile time into Kind::printImpl (host only)
+        void print() const {
+            static_cast<const Kind*>(this)->printImpl();
+        }
+
+        // Default printer, kinds may shadow it with their own printImpl
+        void printImpl() const {
+            printf("%s ID: %d, x: %f, Data: ", Kind::kindName, pID, xyz[0]);
+            for (int k = 0; k < NDATA; ++k) {
+                printf("%f ", data[k]);
+            }
+            printf("\n");
+        }
+};
+
+// Interpolation node: plain increment of the data field
+class NodePoint : public PointBase<NodePoint>
+{
+    public:
+        static constexpr const char* kindName = "NodePoint";
+
+        void updateImpl(float t) {
+            for (int k = 0; k < NDATA; ++k) {
+                data[k] += t;
+            }
+        }
+};
+
+// Gauss quadrature point: increment scaled by the quadrature weight
+class GaussPoint : public PointBase<GaussPoint>
+{
+    private:
+        float gpWeight; // Quadrature weight
+    public:
+        static constexpr const char* kindName = "GaussPoint";
+
+        void setGaussPoint(int id, float x, float weight) {
+            setPoint(id, x);
+            gpWeight = weight;
+        }
+
+        void updateImpl(float t) {
+            for (int k = 0; k < NDATA; ++k) {
+                data[k] += gpWeight * t;
+            }
+        }
+
+        void printImpl() const {
+            printf("%s ID: %d, x: %f, Weight: %f, Data: ", kindName, pID, xyz[0], gpWeight);
+            for (int k = 0; k < NDATA; ++k) {
+                printf("%f ", data[k]);
+            }
+            printf("\n");
+        }
+};
+
+// Boundary node: Dirichlet value, the update only enforces it
+class BoundaryPoint : public PointBase<BoundaryPoint>
+{
+    private:
+        float bcValue; // Imposed value
+    public:
+        static constexpr const char* kindName = "BoundaryPoint";
+
+        void setBoundaryPoint(int id, float x, float value) {
+            setPoint(id, x);
+            bcValue = value;
+        }
+
+        void updateImpl(float) {
+            for (int k = 0; k < NDATA; ++k) {
+                data[k] = bcValue;
+            }
+        }
+};
+
+// CRTP base for element kinds: an element averages the data of the NodePoints it connects
+// (the node count is a parameter since Kind is still incomplete when the base is instantiated)
+template <class Kind, int NN>
+class ElementBase
+{
+    protected:
+        int eID;         // Element ID
+        int nodes[NN];   // Indices into the NodePoint bucket
+        float average;   // Element-averaged data[0]
+    public:
+        void setElement(int id, const int* nodeIdx) {
+            eID = id;
+            for (int n = 0; n < NN; ++n) {
+                nodes[n] = nodeIdx[n];
+            }
+            average = 0.0f;
+        }
+
+        // Statically dispatched evaluation (host/device callable)
+        void evaluate(const NodePoint* pts) {
+            static_cast<Kind*>(this)->evaluateImpl(pts);
+        }
+
+        void print() const {
+            printf("%s ID: %d, Nodes:", Kind::kindName, eID);
+            for (int n = 0; n < NN; ++n) {
+                printf(" %d", nodes[n]);
+            }
+            printf(", Average: %f\n", average);
+        }
+};
+
+// 2-node linear Line element: trapezoidal average
+class LinearLine : public ElementBase<LinearLine, 2>
+{
+    public:
+        static constexpr const char* kindName = "LinearLine";
+
+        void evaluateImpl(const NodePoint* pts) {
+            average = 0.5f * (pts[nodes[0]].getDataEntry(0) + pts[nodes[1]].getDataEntry(0));
+        }
+};
+
+// 3-node quadratic Line element: Simpson average
+class QuadraticLine : public ElementBase<QuadraticLine, 3>
+{
+    public:
+        static constexpr const char* kindName = "QuadraticLine";
+
+        void evaluateImpl(const NodePoint* pts) {
+            average = (pts[nodes[0]].getDataEntry(0)
+                     + 4.0f * pts[nodes[1]].getDataEntry(0)
+                     + pts[nodes[2]].getDataEntry(0)) / 6.0f;
+        }
+};
+
+// Contiguous storage for a single kind (host array mirrored on device)
+// Filled on the host first: once toDevice() has mapped the array, it can no longer grow
+template <class Kind>
+class Bucket
+{
+    private:
+        int count;     // Number of stored objects
+        int capacity;  // Allocated slots
+        Kind* items;   // Contiguous array of objects of the same kind
+        bool onDevice; // Set by toDevice(): items is mapped and must not be reallocated
+    public:
+        Bucket() {
+            count = 0;
+            capacity = 0;
+            items = nullptr;
+            onDevice = false;
+        }
+
+        // Owns items: copies would free it twice
+        Bucket(const Bucket&) = delete;
+        Bucket& operator=(const Bucket&) = delete;
+
+        ~Bucket() {
+            if (onDevice) {
+                #pragma acc exit data delete(items[0:count])
+            }
+            if (items) {
+                free(items);
+                items = nullptr;
+            }
+        }
+
+        // Reserve host storage (host only, before the device copy)
+        void reserve(int n) {
+            assert(!onDevice && "Bucket cannot grow after toDevice()");
+            if (n > capacity) {
+                items = (Kind*)realloc(items, n * sizeof(Kind));
+                capacity = n;
+            }
+        }
+
+        // Append an object, returning its index within the bucket (host only)
+        int push(const Kind& obj) {
+            assert(!onDevice && "Bucket cannot grow after toDevice()");
+            if (count == capacity) {
+                reserve(capacity > 0 ? 2 * capacity : 16);
+            }
+            items[count] = obj;
+            return count++;
+        }
+
+        int size() const { return count; }
+        Kind* data() const { return items; }
+
+        // Single transfer for the whole bucket: kinds hold no pointers
+        void toDevice() {
+            PUSH_RANGE("Bucket::toDevice", 0);
+            #pragma acc enter data copyin(items[0:count])
+            onDevice = true;
+            POP_RANGE
+        }
+
+        void toHost() {
+            PUSH_RANGE("Bucket::toHost", 1);
+            #pragma acc update host(items[0:count])
+            POP_RANGE
+        }
+
+        void print() const {
+            for (int i = 0; i < count; ++i) {
+                items[i].print();
+            }
+        }
+};
+
+// Heterogeneous container sorting objects by kind: one contiguous bucket per type
+template <class... Kinds>
+class KindBuckets
+{
+    private:
+        std::tuple<Bucket<Kinds>...> buckets;
+    public:
+        template <class Kind>
+        Bucket<Kind>& get() { return std::get<Bucket<Kind>>(buckets); }
+
+        template <class Kind>
+        int push(const Kind& obj) { return get<Kind>().push(obj); }
+
+        // Apply a generic functor to every bucket: the functor is instantiated once per kind
+        template <class Functor>
+        void forEachBucket(Functor&& f) {
+            std::apply([&](auto&... b) { (f(b), ...); }, buckets);
+        }
+
+        void toDevice() { forEachBucket([](auto& b) { b.toDevice(); }); }
+        void toHost() { forEachBucket([](auto& b) { b.toHost(); }); }
+        void print() { forEachBucket([](auto& b) { b.print(); }); }
+};
+
+// Per-bucket kernel for point kinds: one specialized, branch-free loop per kind
+struct UpdatePoints
+{
+    float t;
+
+    template <class Kind>
+    void operator()(Bucket<Kind>& b) const {
+        Kind* items = b.data();
+        const int n = b.size();
+        const float dt = t;
+        PUSH_RANGE(Kind::kindName, 2);
+        #pragma acc parallel loop present(items[0:n])
+        for (int i = 0; i < n; ++i) {
+            items[i].update(dt);
+        }
+        POP_RANGE
+    }
+};
+
+// Per-bucket kernel for element kinds, reading from the NodePoint bucket
+struct EvaluateElements
+{
+    const NodePoint* pts;
+    int npts;
+
+    template <class Kind>
+    void operator()(Bucket<Kind>& b) const {
+        Kind* items = b.data();
+        const int n = b.size();
+        const NodePoint* nodes = pts;
+        [[maybe_unused]] const int nn = npts; // Only referenced by the data clause
+        PUSH_RANGE(Kind::kindName, 3);
+        #pragma acc parallel loop present(items[0:n], nodes[0:nn])
+        for (int i = 0; i < n; ++i) {
+            items[i].evaluate(nodes);
+        }
+        POP_RANGE
+    }
+};
+
+// Driver: lines of mixed order, each contributing nodes, boundaries, Gauss points and elements
+int main()
+{
+    const int nlines = 4; // Number of lines
+    const int nelem = 2;  // Elements per line
+
+    KindBuckets<NodePoint, GaussPoint, BoundaryPoint> points;
+    KindBuckets<LinearLine, QuadraticLine> elements;
+
+    // Build the buckets: even lines are linear, odd lines are quadratic
+    PUSH_RANGE("main::build_buckets", 0);
+    int pid = 0;
+    int eid = 0;
+    for (int l = 0; l < nlines; ++l) {
+        const int order = (l % 2 == 0) ? 1 : 2;
+        const int nnodes = nelem * order + 1;
+        const float h = 1.0f / static_cast<float>(nnodes - 1);
+        int first = points.get<NodePoint>().size();
+        for (int i = 0; i < nnodes; ++i) {
+            NodePoint p;
+            p.setPoint(pid++, l + i * h);
+            points.push(p);
+        }
+        // Boundary nodes duplicate the line end points
+        BoundaryPoint b0, b1;
+        b0.setBoundaryPoint(pid++, l, 0.0f);
+        b1.setBoundaryPoint(pid++, l + 1.0f, 1.0f);
+        points.push(b0);
+        points.push(b1);
+        // 2-point Gauss rule per element
+        for (int e = 0; e < nelem; ++e) {
+            const float xc = l + (e + 0.5f) / nelem;
+            const float hw = 0.5f / nelem;
+            GaussPoint g0, g1;
+            g0.setGaussPoint(pid++, xc - 0.577350269f * hw, hw);
+            g1.setGaussPoint(pid++, xc + 0.577350269f * hw, hw);
+            points.push(g0);
+            points.push(g1);
+        }
+        // Elements of the kind matching the line order
+        for (int e = 0; e < nelem; ++e) {
+            int idx[3];
+            for (int n = 0; n <= order; ++n) {
+                idx[n] = first + e * order + n;
+            }
+            if (order == 1) {
+                LinearLine el;
+                el.setElement(eid++, idx);
+                elements.push(el);
+            } else {
+                QuadraticLine el;
+                el.setElement(eid++, idx);
+                elements.push(el);
+            }
+        }
+    }
+    POP_RANGE
+
+    // One device transfer per bucket
+    PUSH_RANGE("main::to_device", 0);
+    points.toDevice();
+    elements.toDevice();
+    POP_RANGE
+
+    // Kernel 1: one launch per point kind, no type test inside any loop
+    PUSH_RANGE("main::update_points", 0);
+    points.forEachBucket(UpdatePoints{1.0f});
+    points.forEachBucket(UpdatePoints{0.5f});
+    POP_RANGE
+
+    // Kernel 2: one launch per element kind
+    PUSH_RANGE("main::evaluate_elements", 0);
+    Bucket<NodePoint>& nodes = points.get<NodePoint>();
+    elements.forEachBucket(EvaluateElements{nodes.data(), nodes.size()});
+    POP_RANGE
+
+    // Copy back and print
+    PUSH_RANGE("main::print", 0);
+    points.toHost();
+    elements.toHost();
+    points.print();
+    elements.print();
+    POP_RANGE
+
+    return 0;
+}
@@ -0,0 +1,322 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Cache-blocked stencils along and across Lines with spatial and temporal blocking
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// POSIX headers
+#include <unistd.h>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Run f(t, begin, end) on nthreads host threads over static blocks of [0, n)
+template <class F>
+void parallelBlocks(int nthreads, long n, F f)
+{
+    std::vector<std::thread> team;
+    for (int t = 1; t < nthreads; ++t) {
+        team.emplace_back(f, t, n * t / nthreads, n * (t + 1) / nthreads);
+    }
+    f(0, 0L, n / nthreads);
+    for (auto& th : team) {
+        th.join();
+    }
+}
+
+/**
+ * @brief Explicit diffusion stencil over Line/Point data stored line by line
+ *
+ * u(l, p) lives at u[l * np + p]. Along a Line the stencil reaches R points on each side
+ * (width 2R + 1); across Lines it couples to the neighbouring Lines l - 1 and l + 1.
+ * Points within R of a Line end and the first/last Line are fixed (Dirichlet).
+ */
+struct Stencil
+{
+    int R;        // Radius along the Line
+    double a[9];  // a[k]: weight of the pair (p - k, p + k), k = 1..R
+    double nu;    // Along-line diffusion number
+    double mu;    // Across-line coupling
+
+    explicit Stencil(int radius) : R(radius), nu(0.2), mu(0.1) {
+        double s = 0.0;
+        for (int k = 1; k <= R; ++k) {
+            a[k] = 1.0 / (k * k);
+            s += a[k];
+        }
+        for (int k = 1; k <= R; ++k) {
+            a[k] /= s;
+        }
+    }
+};
+
+// One Line segment [p0, p1) of one step: dst(p) from src around p; stride is the distance between Lines
+template <int R>
+inline void sweepRow(const Stencil& st, const double* src, double* dst, long stride, long p0, long p1)
+{
+    for (long p = p0; p < p1; ++p) {
+        const double* c = src + p;
+        double s = 0.0;
+        for (int k = 1; k <= R; ++k) {
+            s += st.a[k] * (c[k] + c[-k] - 2.0 * c[0]);
+        }
+        dst[p] = c[0] + st.nu * s + st.mu * (c[stride] + c[-stride] - 2.0 * c[0]);
+    }
+}
+
+// Grid of Lines and the tiling used by the blocked variants
+struct Grid
+{
+    long nl;  // Lines
+    long np;  // Points per Line
+    long tl;  // Lines per tile
+    long tp;  // Points per tile
+};
+
+// Untiled: every step sweeps all Lines from end to end
+template <int R>
+void runUntiled(const Stencil& st, const Grid& g, double*& u, double*& v, int steps, int nthreads)
+{
+    for (int s = 0; s < steps; ++s) {
+        parallelBlocks(nthreads, g.nl - 2, [&](int, long begin, long end) {
+            for (long l = 1 + begin; l < 1 + end; ++l) {
+                sweepRow<R>(st, u + l * g.np, v + l * g.np, g.np, R, g.np - R);
+            }
+        });
+        std::swap(u, v);
+    }
+}
+
+// Spatial blocking: each step walks tiles of tl Lines x tp Points, so the three Lines in use stay in cache
+template <int R>
+void runSpatial(const Stencil& st, const Grid& g, double*& u, double*& v, int steps, int nthreads)
+{
+    const long ntl = (g.nl - 2 + g.tl - 1) / g.tl;
+    const long ntp = (g.np - 2 * R + g.tp - 1) / g.tp;
+    for (int s = 0; s < steps; ++s) {
+        parallelBlocks(nthreads, ntl * ntp, [&](int, long begin, long end) {
+            for (long t = begin; t < end; ++t) {
+                const long l0 = 1 + (t / ntp) * g.tl, l1 = std::min(l0 + g.tl, g.nl - 1);
+                const long p0 = R + (t % ntp) * g.tp, p1 = std::min(p0 + g.tp, g.np - R);
+                for (long l = l0; l < l1; ++l) {
+                    sweepRow<R>(st, u + l * g.np, v + l * g.np, g.np, p0, p1);
+                }
+            }
+        });
+        std::swap(u, v);
+    }
+}
+
+/**
+ * @brief Temporal blocking with overlapped tiles: T steps fused per tile
+ *
+ * Each tile loads its region extended by T Lines and R*T Points (the dependency cone of T
+ * steps) into a thread-local scratch pair, advances T steps there while the computed region
+ * shrinks, and writes back only its own interior. Main memory is swept once per T steps at
+ * the cost of recomputing the halos.
+ */
+template <int R>
+void runTemporal(const Stencil& st, const Grid& g, double*& u, double*& v, int steps, int T, int nthreads)
+{
+    const long ntl = (g.nl - 2 + g.tl - 1) / g.tl;
+    const long ntp = (g.np - 2 * R + g.tp - 1) / g.tp;
+    for (int done = 0; done < steps; done += T) {
+        const int nt = std::min(T, steps - done);
+        parallelBlocks(nthreads, ntl * ntp, [&](int, long begin, long end) {
+            const long W = g.tp + 2L * R * nt;
+            std::vector<double> bufA((g.tl + 2L * nt) * W), bufB(bufA.size());
+            for (long t = begin; t < end; ++t) {
+                const long l0 = 1 + (t / ntp) * g.tl, l1 = std::min(l0 + g.tl, g.nl - 1);
+                const long p0 = R + (t % ntp) * g.tp, p1 = std::min(p0 + g.tp, g.np - R);
+                // Extended region [e0, e1) x [q0, q1), stored with row stride W
+                const long e0 = std::max(0L, l0 - nt), e1 = std::min(g.nl, l1 + nt);
+                const long q0 = std::max(0L, p0 - (long)R * nt), q1 = std::min(g.np, p1 + (long)R * nt);
+                double* a = bufA.data();
+                double* b = bufB.data();
+                for (long l = e0; l < e1; ++l) {
+                    memcpy(a + (l - e0) * W, u + l * g.np + q0, (q1 - q0) * sizeof(double));
+                    memcpy(b + (l - e0) * W, u + l * g.np + q0, (q1 - q0) * sizeof(double));
+                }
+                for (int s = 1; s <= nt; ++s) {
+                    const long halo = nt - s;
+                    const long c0 = std::max(1L, l0 - halo), c1 = std::min(g.nl - 1, l1 + halo);
+                    const long r0 = std::max((long)R, p0 - R * halo), r1 = std::min(g.np - R, p1 + R * halo);
+                    for (long l = c0; l < c1; ++l) {
+                        // Shift the row pointers so sweepRow can use global Point indices
+                        sweepRow<R>(st, a + (l - e0) * W - q0, b + (l - e0) * W - q0, W, r0, r1);
+                    }
+                    std::swap(a, b);
+                }
+                for (long l = l0; l < l1; ++l) {
+                    memcpy(v + l * g.np + p0, a + (l - e0) * W + (p0 - q0), (p1 - p0) * sizeof(double));
+                }
+            }
+        });
+        std::swap(u, v);
+    }
+}
+
+// Both arrays start equal, so the fixed boundary values are present in either buffer
+void initGrid(const Grid& g, double* u, double* v, int nthreads)
+{
+    parallelBlocks(nthreads, g.nl, [&](int, long begin, long end) {
+        for (long l = begin; l < end; ++l) {
+            for (long p = 0; p < g.np; ++p) {
+                const double x = (double)p / g.np, y = (double)l / g.nl;
+                u[l * g.np + p] = sin(6.0 * x) * cos(4.0 * y) + ((p * 7 + l * 3) % 13) * 0.01;
+            }
+            memcpy(v + l * g.np, u + l * g.np, g.np * sizeof(double));
+        }
+    });
+}
+
+enum Variant { UNTILED, SPATIAL, TEMPORAL };
+
+// Run one variant from the initial state; returns the seconds spent and leaves the result in 'out'
+template <int R>
+double runVariant(Variant var, const Stencil& st, const Grid& g, int steps, int T, int nthreads, double*& out)
+{
+    const size_t n = (size_t)g.nl * g.np;
+    double* u = (double*)malloc(n * sizeof(double));
+    double* v = (double*)malloc(n * sizeof(double));
+    initGrid(g, u, v, nthreads);
+
+    [[maybe_unused]] const char* names[] = { "untiled", "spatial", "temporal" }; // Only used by the NVTX range
+    PUSH_RANGE(names[var], var);
+    const auto t0 = std::chrono::steady_clock::now();
+    if (var == UNTILED) {
+        runUntiled<R>(st, g, u, v, steps, nthreads);
+    } else if (var == SPATIAL) {
+        runSpatial<R>(st, g, u, v, steps, nthreads);
+    } else {
+        runTemporal<R>(st, g, u, v, steps, T, nthreads);
+    }
+    const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    POP_RANGE
+
+    free(v);
+    out = u;
+    return t;
+}
+
+template <int R>
+int benchmark(const Grid& g, int steps, int T, int nthreads)
+{
+    const Stencil st(R);
+    const size_t n = (size_t)g.nl * g.np;
+    // Effective traffic of one step: read u and write v once
+    const double bytes = 2.0 * n * sizeof(double) * steps;
+
+    printf("%-9s | %9s | %10s | %10s | %7s | %s\n", "variant", "time [s]", "eff. GB/s", "MLUP/s", "speedup", "max diff");
+    double* ref = nullptr;
+    const double tRef = runVariant<R>(UNTILED, st, g, steps, T, nthreads, ref);
+    printf("%-9s | %9.3f | %10.2f | %10.1f | %6.2fx | %s\n", "untiled", tRef, bytes / tRef * 1.0e-9,
+           (double)n * steps / tRef * 1.0e-6, 1.0, "-");
+
+    double maxDiff = 0.0;
+    const Variant vars[] = { SPATIAL, TEMPORAL };
+    for (Variant var : vars) {
+        double* res = nullptr;
+        const double t = runVariant<R>(var, st, g, steps, T, nthreads, res);
+        double diff = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            diff = std::max(diff, std::fabs(res[i] - ref[i]));
+        }
+        maxDiff = std::max(maxDiff, diff);
+        char label[32];
+        snprintf(label, sizeof(label), var == SPATIAL ? "spatial" : "T=%d", T);
+        printf("%-9s | %9.3f | %10.2f | %10.1f | %6.2fx | %.1e\n", label, t, bytes / t * 1.0e-9,
+               (double)n * steps / t * 1.0e-6, tRef / t, diff);
+        free(res);
+    }
+    free(ref);
+    return (maxDiff == 0.0) ? 0 : 1;
+}
+
+int main(int argc, const char** argv)
+{
+    // Size the grid from the last-level cache: each array is about twice the LLC by default
+    long llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (llc <= 0) {
+        llc = 32L << 20;
+    }
+    const int R = (argc > 1) ? atoi(argv[1]) : 2;         // Stencil radius along the Line (width 2R + 1)
+    Grid g;
+    g.nl = (argc > 2) ? atol(argv[2]) : 1024;              // Lines
+    g.np = (argc > 3) ? atol(argv[3]) : std::max(4096L, 2 * llc / (long)sizeof(double) / g.nl);
+    const int steps = (argc > 4) ? atoi(argv[4]) : 8;      // Time steps
+    const int T = (argc > 5) ? atoi(argv[5]) : 4;          // Steps fused per tile (temporal blocking)
+    g.tl = (argc > 6) ? atol(argv[6]) : 32;                // Lines per tile
+    g.tp = (argc > 7) ? atol(argv[7]) : 2048;              // Points per tile
+    const int nthreads = (int)std::max(1u, std::thread::hardware_concurrency());
+
+    if (R < 1 || R > 8 || g.nl < 3 || g.np <= 2 * R || steps < 1 || T < 1 || g.tl < 1 || g.tp < 1) {
+        fprintf(stderr, "Usage: %s [R<=8] [nlines] [npoints] [steps] [T] [tileLines] [tilePoints]\n", argv[0]);
+        return 1;
+    }
+    g.tl = std::min(g.tl, g.nl - 2);
+    g.tp = std::min(g.tp, g.np - 2L * R);
+
+    const double mb = (double)g.nl * g.np * sizeof(double) / 1.0e6;
+    printf("Stencil width %d along Lines + neighbouring Lines, %ld lines x %ld points\n", 2 * R + 1, g.nl, g.np);
+    printf("Array %.1f MB (%.1fx LLC of %.1f MB), %d steps, tiles %ld x %ld, %d threads\n",
+           mb, mb * 1.0e6 / llc, llc / 1.0e6, steps, g.tl, g.tp, nthreads);
+
+    switch (R) {
+        case 1: return benchmark<1>(g, steps, T, nthreads);
+        case 2: return benchmark<2>(g, steps, T, nthreads);
+        case 3: return benchmark<3>(g, steps, T, nthreads);
+        case 4: return benchmark<4>(g, steps, T, nthreads);
+        case 5: return benchmark<5>(g, steps, T, nthreads);
+        case 6: return benchmark<6>(g, steps, T, nthreads);
+        case 7: return benchmark<7>(g, steps, T, nthreads);
+        default: return benchmark<8>(g, steps, T, nthreads);
+    }
+}
@@ -0,0 +1,445 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Dependency-graph task runtime for the construction, transfer and kernel phases of self_instantiation_adv
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+/**
+ * @brief Explicit task DAG: tasks declare the objects they read and write
+ *
+ * Edges are derived in insertion order, as a sequential program would see them: a task
+ * depends on the last writer of everything it touches (read-after-write, write-after-write)
+ * and, when it writes, on the readers since that write (write-after-read). Any valid schedule
+ * of the graph therefore gives the same result as running the tasks in insertion order.
+ */
+class TaskGraph
+{
+    public:
+        using Handle = const void*;
+    private:
+        struct Task
+        {
+            std::string name;
+            std::function<void()> fn;
+            std::vector<int> succ;
+            int npred = 0;
+            double start = 0.0, end = 0.0; // Seconds since the run started
+            int worker = -1;
+        };
+        struct Access
+        {
+            int lastWriter = -1;
+            std::vector<int> readers; // Since the last write
+        };
+        std::vector<Task> tasks;
+        std::unordered_map<Handle, Access> access;
+
+        void addEdge(int from, int to) {
+            if (from < 0 || from == to) {
+                return;
+            }
+            std::vector<int>& s = tasks[from].succ;
+            if (std::find(s.begin(), s.end(), to) == s.end()) {
+                s.push_back(to);
+                tasks[to].npred++;
+            }
+        }
+    public:
+        int add(std::string name, std::initializer_list<Handle> reads, std::initializer_list<Handle> writes,
+                std::function<void()> fn) {
+            return add(std::move(name), std::vector<Handle>(reads), std::vector<Handle>(writes), std::move(fn));
+        }
+
+        int add(std::string name, const std::vector<Handle>& reads, const std::vector<Handle>& writes,
+                std::function<void()> fn) {
+            const int id = (int)tasks.size();
+            tasks.push_back(Task{ std::move(name), std::move(fn), {}, 0, 0.0, 0.0, -1 });
+            for (Handle h : reads) {
+                Access& a = access[h];
+                addEdge(a.lastWriter, id);
+                a.readers.push_back(id);
+            }
+            for (Handle h : writes) {
+                Access& a = access[h];
+                addEdge(a.lastWriter, id);
+                for (int r : a.readers) {
+                    addEdge(r, id);
+                }
+                a.lastWriter = id;
+                a.readers.clear();
+            }
+            return id;
+        }
+
+        int size() const { return (int)tasks.size(); }
+        int numEdges() const {
+            int e = 0;
+            for (const Task& t : tasks) {
+                e += (int)t.succ.size();
+            }
+            return e;
+        }
+
+        // Runs the tasks in insertion order on the calling thread
+        double runSerial() {
+            auto t0 = std::chrono::steady_clock::now();
+            for (Task& t : tasks) {
+                t.start = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                t.fn();
+                t.end = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                t.worker = 0;
+            }
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        }
+
+        // Runs the graph on nthreads workers (the caller included); a task starts once its predecessors end
+        double run(int nthreads) {
+            std::vector<std::atomic<int>> pending(tasks.size());
+            std::deque<int> ready;
+            std::mutex mtx;
+            std::condition_variable cv;
+            int remaining = (int)tasks.size();
+            for (size_t i = 0; i < tasks.size(); ++i) {
+                pending[i].store(tasks[i].npred);
+                if (tasks[i].npred == 0) {
+                    ready.push_back((int)i);
+                }
+            }
+            auto t0 = std::chrono::steady_clock::now();
+            auto now = [&] { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); };
+
+            auto worker = [&](int w) {
+                std::unique_lock<std::mutex> lock(mtx);
+                while (true) {
+                    cv.wait(lock, [&] { return !ready.empty() || remaining == 0; });
+                    if (remaining == 0) {
+                        return;
+                    }
+                    const int id = ready.front();
+                    ready.pop_front();
+                    lock.unlock();
+
+                    Task& t = tasks[id];
+                    t.worker = w;
+                    t.start = now();
+                    t.fn();
+                    t.end = now();
+
+                    lock.lock();
+                    for (int s : t.succ) {
+                        if (pending[s].fetch_sub(1) == 1) {
+                            ready.push_back(s);
+                        }
+                    }
+                    remaining--;
+                    cv.notify_all();
+                }
+            };
+            std::vector<std::thread> team;
+            for (int w = 1; w < nthreads; ++w) {
+                team.emplace_back(worker, w);
+            }
+            worker(0);
+            for (auto& th : team) {
+                th.join();
+            }
+            return now();
+        }
+
+        /**
+         * @brief Longest path through the graph using the measured task durations
+         *
+         * Tasks are inserted after all their predecessors, so insertion order is a topological order.
+         */
+        double criticalPath(std::vector<int>& path) const {
+            const int n = size();
+            std::vector<double> finish(n, 0.0);
+            std::vector<int> from(n, -1);
+            std::vector<double> ready(n, 0.0);
+            std::vector<int> readyFrom(n, -1);
+            for (int i = 0; i < n; ++i) {
+                finish[i] = ready[i] + (tasks[i].end - tasks[i].start);
+                from[i] = readyFrom[i];
+                for (int s : tasks[i].succ) {
+                    if (finish[i] > ready[s]) {
+                        ready[s] = finish[i];
+                        readyFrom[s] = i;
+                    }
+                }
+            }
+            int last = (int)(std::max_element(finish.begin(), finish.end()) - finish.begin());
+            path.clear();
+            for (int i = last; i >= 0; i = from[i]) {
+                path.push_back(i);
+            }
+            std::reverse(path.begin(), path.end());
+            return finish[last];
+        }
+
+        double totalWork() const {
+            double w = 0.0;
+            for (const Task& t : tasks) {
+                w += t.end - t.start;
+            }
+            return w;
+        }
+
+        const std::string& name(int i) const { return tasks[i].name; }
+        double duration(int i) const { return tasks[i].end - tasks[i].start; }
+};
+
+// Parent Point class (from self_instantiation_adv)
+class Point
+{
+    protected:
+        int pID;      // Point ID
+        int dataSize; // Data field size
+        float* xyz;   // Coordinates in 3D
+        float* data;  // Data field array
+    public:
+        // Set point parameters and deep-copy the point to the device (host only)
+        void setPoint(int id, int size) {
+            pID = id;
+            dataSize = size;
+            xyz = (float*)calloc(3, sizeof(float));
+            data = (float*)calloc(size, sizeof(float));
+            // Some host-side preparation per point
+            xyz[0] = std::cos(0.001f * id);
+            xyz[1] = std::sin(0.001f * id);
+            for (int k = 0; k < size; ++k) {
+                data[k] = xyz[0] * k + xyz[1];
+            }
+            #pragma acc enter data copyin(this[0:1])
+            #pragma acc enter data copyin(xyz[0:3])
+            #pragma acc enter data copyin(data[0:dataSize])
+        }
+        void setPointDataEntry(int idx, float value) { data[idx] += value; }
+        float getDataEntry(int idx) const { return data[idx]; }
+        void updateHost() {
+            #pragma acc update host(data[0:dataSize])
+        }
+};
+
+// Child GaussPoint class, derived from Point
+class GaussPoint : public Point
+{
+    private:
+        float gpWeight;
+    public:
+        void setGaussPoint(int id, int size, float weight) {
+            this->setPoint(id, size);
+            gpWeight = weight;
+        }
+        float getWeight() const { return gpWeight; }
+};
+
+// Line class from self_instantiation_adv, with setLine split into its phases
+class Line
+{
+    private:
+        int lineID;
+        int numPoints;
+        int numGaussPoints;
+        Point* points;
+        GaussPoint* gaussPoints;
+    public:
+        void createThis(int id, int np, int ngp) {
+            lineID = id;
+            numPoints = np;
+            numGaussPoints = ngp;
+            points = nullptr;
+            gaussPoints = nullptr;
+            #pragma acc enter data copyin(this[0:1])
+        }
+        void createPoints() {
+            points = new Point[numPoints];
+            #pragma acc enter data create(points[0:numPoints])
+        }
+        void createGaussPoints() {
+            gaussPoints = new GaussPoint[numGaussPoints];
+            #pragma acc enter data create(gaussPoints[0:numGaussPoints])
+        }
+        void fillPoints() {
+            for (int i = 0; i < numPoints; ++i) {
+                points[i].setPoint(lineID * numPoints + i, 5);
+            }
+        }
+        void fillGaussPoints() {
+            for (int i = 0; i < numGaussPoints; ++i) {
+                gaussPoints[i].setGaussPoint(lineID * numGaussPoints + i, 5, 1.0f);
+            }
+        }
+        int getNPoints() const { return numPoints; }
+        int getNGaussPoints() const { return numGaussPoints; }
+        Point& point(int i) { return points[i]; }
+        GaussPoint& gaussPoint(int i) { return gaussPoints[i]; }
+        // Handles for the task graph: the object itself and the two arrays it owns
+        const void* handle() const { return this; }
+        const void* pointsHandle() const { return &points; }
+        const void* gaussPointsHandle() const { return &gaussPoints; }
+        // Checksum of the host copies
+        double checksum() {
+            double s = 0.0;
+            for (int i = 0; i < numPoints; ++i) {
+                points[i].updateHost();
+                s += points[i].getDataEntry(0);
+            }
+            for (int i = 0; i < numGaussPoints; ++i) {
+                gaussPoints[i].updateHost();
+                s += gaussPoints[i].getDataEntry(1);
+            }
+            return s;
+        }
+};
+
+// Builds the graph of the self_instantiation_adv phases over nlines lines
+void buildGraph(TaskGraph& g, Line* lines, int nlines, int np, int ngp, float* coeffs, double* sums)
+{
+    // Host-side preparation of the kernel coefficients, independent of the construction
+    g.add("prepare_coeffs", {}, { coeffs }, [=] {
+        for (int i = 0; i < 5; ++i) {
+            coeffs[i] = 1.5f * i;
+        }
+        #pragma acc enter data copyin(coeffs[0:5])
+    });
+
+    for (int l = 0; l < nlines; ++l) {
+        Line* line = &lines[l];
+        const std::string s = std::to_string(l);
+        g.add("create_this_" + s, {}, { line->handle() }, [=] { line->createThis(l, np, ngp); });
+        g.add("create_points_" + s, { line->handle() }, { line->pointsHandle() }, [=] { line->createPoints(); });
+        g.add("create_gauss_" + s, { line->handle() }, { line->gaussPointsHandle() }, [=] { line->createGaussPoints(); });
+        g.add("fill_points_" + s, {}, { line->pointsHandle() }, [=] { line->fillPoints(); });
+        g.add("fill_gauss_" + s, {}, { line->gaussPointsHandle() }, [=] { line->fillGaussPoints(); });
+    }
+
+    // One kernel per line, as the gang loop of main
+    for (int l = 0; l < nlines; ++l) {
+        Line* line = &lines[l];
+        g.add("kernel_" + std::to_string(l), { coeffs, line->handle() }, { line->pointsHandle(), line->gaussPointsHandle() }, [=] {
+            const int n = line->getNPoints(), m = line->getNGaussPoints();
+            #pragma acc parallel loop present(line[0:1], coeffs[0:5])
+            for (int i = 0; i < n; ++i) {
+                line->point(i).setPointDataEntry(0, coeffs[i % 5]);
+            }
+            #pragma acc parallel loop present(line[0:1], coeffs[0:5])
+            for (int i = 0; i < m; ++i) {
+                line->gaussPoint(i).setPointDataEntry(1, coeffs[(i + 1) % 5]);
+            }
+        });
+    }
+
+    // Output per line
+    for (int l = 0; l < nlines; ++l) {
+        Line* line = &lines[l];
+        g.add("print_" + std::to_string(l), { line->pointsHandle(), line->gaussPointsHandle() }, { &sums[l] },
+              [=] { sums[l] = line->checksum(); });
+    }
+}
+
+double runOnce(bool serial, int nthreads, int nlines, int np, int ngp, bool report)
+{
+    Line* lines = new Line[nlines];
+    float coeffs[5];
+    std::vector<double> sums(nlines, 0.0);
+    #pragma acc enter data create(lines[0:nlines])
+
+    TaskGraph g;
+    buildGraph(g, lines, nlines, np, ngp, coeffs, sums.data());
+    const double makespan = serial ? g.runSerial() : g.run(nthreads);
+
+    double total = 0.0;
+    for (int l = 0; l < nlines; ++l) {
+        total += sums[l];
+    }
+    std::vector<int> path;
+    const double cp = g.criticalPath(path);
+    printf("%-8s: %d tasks, %d edges, %d threads: makespan %8.2f ms, total work %8.2f ms, critical path %8.2f ms, checksum %.6e\n",
+           serial ? "serial" : "graph", g.size(), g.numEdges(), serial ? 1 : nthreads, 1e3 * makespan,
+           1e3 * g.totalWork(), 1e3 * cp, total);
+    if (report) {
+        printf("  parallelism (work / critical path): %.2f\n", g.totalWork() / cp);
+        printf("  critical path:");
+        for (int i : path) {
+            printf(" %s (%.2f ms)", g.name(i).c_str(), 1e3 * g.duration(i));
+        }
+        printf("\n");
+    }
+    // Objects are leaked on purpose, as in self_instantiation_adv (no destructors yet)
+    return makespan;
+}
+
+int main(int argc, const char** argv)
+{
+    const int nlines = (argc > 1) ? atoi(argv[1]) : 16;   // Number of lines
+    const int np = (argc > 2) ? atoi(argv[2]) : 20000;    // Points per line
+    const int ngp = (argc > 3) ? atoi(argv[3]) : 10000;   // Gauss points per line
+    const int nthreads = (argc > 4) ? atoi(argv[4]) : (int)std::max(1u, std::thread::hardware_concurrency());
+
+    PUSH_RANGE("main::serial", 0);
+    const double tSerial = runOnce(true, 1, nlines, np, ngp, false);
+    POP_RANGE
+    PUSH_RANGE("main::graph", 1);
+    const double tGraph = runOnce(false, nthreads, nlines, np, ngp, true);
+    POP_RANGE
+    printf("speedup over the serial phases: %.2fx\n", tSerial / tGraph);
+
+    return 0;
+}
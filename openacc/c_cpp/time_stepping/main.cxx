@@ -0,0 +1,467 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Explicit time stepping (forward Euler, RK4) over device-resident Point payloads with per-step latency metrics
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <acc_prof.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Number of fields per point: two (a, b) pairs rotated at the line's frequency
+const int NFIELDS = 4;
+
+// Point class containing an id and a dynamic float array (from array_of_objects)
+class Point
+{
+    private:
+        int pID;      // Unique identifier for the Point
+        int dataSize; // Size of the data array in elements
+        float* pData; // Data pointer as a dynamic array of floats
+    public:
+        int getId() const { return pID; }
+        int getDataSize() const { return dataSize; }
+        float* getData() const { return pData; }
+        void setPoint(int id, int n) {
+            pID = id;
+            dataSize = n;
+            pData = (float*)calloc(n, sizeof(float));
+            #pragma acc enter data copyin(pData[0:dataSize]) // Attached to the device copy of this Point
+        }
+};
+
+// Line class contains an array of Point objects and the frequency of its oscillators
+class Line
+{
+    private:
+        int lID;       // Unique identifier for the Line
+        int nPoints;   // Number of Point objects in this Line
+        float omega;   // Rotation frequency of the (a, b) pairs
+        Point* points; // Pointer to an array of Point objects
+    public:
+        int getNPoints() const { return nPoints; }
+        float getOmega() const { return omega; }
+        Point* getPoints() const { return points; }
+        void setLine(int id, int np, float w) {
+            lID = id;
+            nPoints = np;
+            omega = w;
+            points = (Point*)calloc(np, sizeof(Point));
+            #pragma acc enter data copyin(points[0:nPoints]) // Attached to the device copy of this Line
+            for (int i = 0; i < np; ++i) {
+                points[i].setPoint(lID * np + i, NFIELDS);
+            }
+        }
+};
+
+// Transfers issued inside the time loop, as reported by the OpenACC profiling interface.
+// The runtime sees every copy, so implicit ones (reduction results, undeclared arrays) count too.
+struct TransferLog
+{
+    long toHostCount = 0, toHostBytes = 0;
+    long toDeviceCount = 0, toDeviceBytes = 0;
+};
+
+#ifndef NOACC
+static TransferLog* activeLog = nullptr;
+
+// Profiling callback for the upload and download events
+static void onTransfer(acc_prof_info* prof, acc_event_info* event, acc_api_info*)
+{
+    if (activeLog == nullptr) {
+        return;
+    }
+    const long bytes = (long)event->data_event.bytes;
+    if (prof->event_type == acc_ev_enqueue_download_start) {
+        activeLog->toHostCount++;
+        activeLog->toHostBytes += bytes;
+    } else {
+        activeLog->toDeviceCount++;
+        activeLog->toDeviceBytes += bytes;
+    }
+}
+#endif
+
+// Start counting transfers into log (host-only builds issue none)
+void startTransferLog([[maybe_unused]] TransferLog& log)
+{
+#ifndef NOACC
+    activeLog = &log;
+    acc_prof_register(acc_ev_enqueue_upload_start, onTransfer, acc_reg);
+    acc_prof_register(acc_ev_enqueue_download_start, onTransfer, acc_reg);
+#endif
+}
+
+void stopTransferLog()
+{
+#ifndef NOACC
+    acc_prof_unregister(acc_ev_enqueue_upload_start, onTransfer, acc_reg);
+    acc_prof_unregister(acc_ev_enqueue_download_start, onTransfer, acc_reg);
+    activeLog = nullptr;
+#endif
+}
+
+/**
+ * @brief Device-resident scratch for the integrator stages, allocated once
+ *
+ * Every stage is a flat array indexed by point ID and field, created on the device at start-up.
+ * The time loop only hands out these buffers, so no step allocates or maps memory.
+ */
+class StagePool
+{
+    private:
+        int nstages;
+        long perStage;
+        float* buffer;
+        long allocations;
+    public:
+        StagePool(int n, long valuesPerStage) : nstages(n), perStage(valuesPerStage), allocations(0) {
+            buffer = (float*)calloc(nstages * perStage, sizeof(float));
+            allocations++;
+            #pragma acc enter data create(buffer[0:nstages*perStage])
+        }
+        ~StagePool() {
+            #pragma acc exit data delete(buffer[0:nstages*perStage])
+            free(buffer);
+        }
+        float* stage(int s) const { return buffer + s * perStage; }
+        long getAllocations() const { return allocations; }
+};
+
+// Per-step latency histogram with power-of-two buckets starting at 1 us
+class LatencyHistogram
+{
+    private:
+        static const int NBUCKETS = 24;
+        long buckets[NBUCKETS];
+        std::vector<double> samples; // Reserved up front, so recording never allocates
+    public:
+        explicit LatencyHistogram(long nsamples) : buckets{} { samples.reserve(nsamples); }
+        void record(double seconds) {
+            samples.push_back(seconds);
+            const double us = seconds * 1e6;
+            int b = 0;
+            while (b < NBUCKETS - 1 && us >= (double)(1L << (b + 1))) {
+                ++b;
+            }
+            buckets[b]++;
+        }
+        void report(const char* name) {
+            std::vector<double> s(samples);
+            std::sort(s.begin(), s.end());
+            auto pct = [&](double p) { return 1e6 * s[std::min(s.size() - 1, (size_t)(p * s.size()))]; };
+            printf("%s step latency: p50 %.1f us, p90 %.1f us, p99 %.1f us, max %.1f us\n",
+                   name, pct(0.50), pct(0.90), pct(0.99), 1e6 * s.back());
+            const long peak = *std::max_element(buckets, buckets + NBUCKETS);
+            for (int b = 0; b < NBUCKETS; ++b) {
+                if (buckets[b] == 0) {
+                    continue;
+                }
+                printf("  [%7ld, %7ld) us %8ld ", b == 0 ? 0L : (1L << b), 1L << (b + 1), buckets[b]);
+                for (int k = 0; k < (int)(40 * buckets[b] / peak); ++k) {
+                    printf("#");
+                }
+                printf("\n");
+            }
+        }
+};
+
+/**
+ * @brief Right-hand side evaluated at y = u + c * kprev, written to kout
+ *
+ * kprev is always a device-resident stage; with c = 0 it is not read, which is how the first stage is evaluated.
+ * Each (a, b) pair rotates at the line's frequency, and each field diffuses along the line
+ * with zero-flux ends. Diffusion conserves the line sums, so the sums of (a, b) over a line
+ * rotate exactly: that is the accuracy check.
+ */
+void evalStage(Line* lines, int nlines, int np, const float* kprev, float c, float* kout, float nu, [[maybe_unused]] long nvals)
+{
+    const bool useprev = (c != 0.0f);
+    #pragma acc parallel loop gang present(lines[0:nlines], kprev[0:nvals], kout[0:nvals])
+    for (int l = 0; l < nlines; ++l) {
+        const float w = lines[l].getOmega();
+        Point* pts = lines[l].getPoints();
+        #pragma acc loop vector
+        for (int i = 0; i < np; ++i) {
+            const int il = (i > 0) ? i - 1 : i;
+            const int ir = (i < np - 1) ? i + 1 : i;
+            const long base = (long)(l * np + i) * NFIELDS;
+            const long bl = (long)(l * np + il) * NFIELDS;
+            const long br = (long)(l * np + ir) * NFIELDS;
+            float y[NFIELDS], yl[NFIELDS], yr[NFIELDS];
+            #pragma acc loop seq
+            for (int k = 0; k < NFIELDS; ++k) {
+                y[k] = pts[i].getData()[k] + (useprev ? c * kprev[base + k] : 0.0f);
+                yl[k] = pts[il].getData()[k] + (useprev ? c * kprev[bl + k] : 0.0f);
+                yr[k] = pts[ir].getData()[k] + (useprev ? c * kprev[br + k] : 0.0f);
+            }
+            #pragma acc loop seq
+            for (int k = 0; k < NFIELDS; k += 2) {
+                kout[base + k] = w * y[k + 1] + nu * (yl[k] - 2.0f * y[k] + yr[k]);
+                kout[base + k + 1] = -w * y[k] + nu * (yl[k + 1] - 2.0f * y[k + 1] + yr[k + 1]);
+            }
+        }
+    }
+}
+
+// u += dt * sum_s coef[s] * k_s
+void combine(Line* lines, int nlines, int np, const StagePool& pool, int nstages, const float* coef, float dt, [[maybe_unused]] long nvals)
+{
+    const float* k0 = pool.stage(0);
+    const float* k1 = pool.stage(1);
+    const float* k2 = pool.stage(2);
+    const float* k3 = pool.stage(3);
+    const float c0 = coef[0], c1 = coef[1], c2 = coef[2], c3 = coef[3];
+    #pragma acc parallel loop gang present(lines[0:nlines], k0[0:nvals], k1[0:nvals], k2[0:nvals], k3[0:nvals])
+    for (int l = 0; l < nlines; ++l) {
+        Point* pts = lines[l].getPoints();
+        #pragma acc loop vector
+        for (int i = 0; i < np; ++i) {
+            const long base = (long)(l * np + i) * NFIELDS;
+            float* u = pts[i].getData();
+            #pragma acc loop seq
+            for (int k = 0; k < NFIELDS; ++k) {
+                float inc = c0 * k0[base + k];
+                if (nstages > 1) {
+                    inc += c1 * k1[base + k] + c2 * k2[base + k] + c3 * k3[base + k];
+                }
+                u[k] += dt * inc;
+            }
+        }
+    }
+}
+
+// Diagnostic: total energy sum(u^2); the reduction result is a device-to-host scalar transfer
+double energy(Line* lines, int nlines, int np)
+{
+    double e = 0.0;
+    #pragma acc parallel loop gang present(lines[0:nlines]) reduction(+:e)
+    for (int l = 0; l < nlines; ++l) {
+        Point* pts = lines[l].getPoints();
+        #pragma acc loop vector reduction(+:e)
+        for (int i = 0; i < np; ++i) {
+            for (int k = 0; k < NFIELDS; ++k) {
+                e += (double)pts[i].getData()[k] * pts[i].getData()[k];
+            }
+        }
+    }
+    return e;
+}
+
+// Host copy of every payload (explicit deep update), optionally written to a file
+void checkpoint(Line* lines, int nlines, int np, FILE* f)
+{
+    for (int l = 0; l < nlines; ++l) {
+        Point* pts = lines[l].getPoints();
+        for (int i = 0; i < np; ++i) {
+            float* u = pts[i].getData();
+            #pragma acc update self(u[0:NFIELDS])
+            if (f) {
+                fwrite(u, sizeof(float), NFIELDS, f);
+            }
+        }
+    }
+    if (f) {
+        fflush(f);
+        rewind(f);
+    }
+}
+
+// Initial condition: smooth in i, different per field
+void initialize(Line* lines, int nlines, int np)
+{
+    for (int l = 0; l < nlines; ++l) {
+        Point* pts = lines[l].getPoints();
+        for (int i = 0; i < np; ++i) {
+            for (int k = 0; k < NFIELDS; ++k) {
+                pts[i].getData()[k] = std::cos(0.3f * i + k) + 0.1f * k;
+            }
+            [[maybe_unused]] float* u = pts[i].getData();
+            #pragma acc update device(u[0:NFIELDS])
+        }
+    }
+}
+
+// Line sums of each field (host copies must be current)
+void lineSums(Line* lines, int nlines, int np, std::vector<double>& sums)
+{
+    for (int l = 0; l < nlines; ++l) {
+        for (int k = 0; k < NFIELDS; ++k) {
+            double s = 0.0;
+            for (int i = 0; i < np; ++i) {
+                s += lines[l].getPoints()[i].getData()[k];
+            }
+            sums[l * NFIELDS + k] = s;
+        }
+    }
+}
+
+struct RunConfig
+{
+    int nsteps;
+    float dt;
+    float nu;
+    int outputEvery;
+    int checkpointEvery;
+    const char* checkpointFile;
+};
+
+void run(const char* name, bool rk4, Line* lines, int nlines, int np, const RunConfig& cfg)
+{
+    const long nvals = (long)nlines * np * NFIELDS;
+    initialize(lines, nlines, np);
+
+    // Reference: line sums rotate by omega * t
+    std::vector<double> sums0(nlines * NFIELDS), sums(nlines * NFIELDS);
+    lineSums(lines, nlines, np, sums0);
+
+    StagePool pool(4, nvals);
+    TransferLog log;
+    LatencyHistogram hist(cfg.nsteps);
+    FILE* ckpt = cfg.checkpointFile ? fopen(cfg.checkpointFile, "wb") : nullptr;
+
+    const float euler[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+    const float rk[4] = { 1.0f / 6.0f, 2.0f / 6.0f, 2.0f / 6.0f, 1.0f / 6.0f };
+    const float dt = cfg.dt;
+    double tExposed = 0.0;
+
+    PUSH_RANGE(rk4 ? "run::rk4" : "run::euler", rk4 ? 1 : 0);
+    startTransferLog(log);
+    auto tStart = std::chrono::steady_clock::now();
+    for (int step = 1; step <= cfg.nsteps; ++step) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (rk4) {
+            evalStage(lines, nlines, np, pool.stage(0), 0.0f, pool.stage(0), cfg.nu, nvals);
+            evalStage(lines, nlines, np, pool.stage(0), 0.5f * dt, pool.stage(1), cfg.nu, nvals);
+            evalStage(lines, nlines, np, pool.stage(1), 0.5f * dt, pool.stage(2), cfg.nu, nvals);
+            evalStage(lines, nlines, np, pool.stage(2), dt, pool.stage(3), cfg.nu, nvals);
+            combine(lines, nlines, np, pool, 4, rk, dt, nvals);
+        } else {
+            evalStage(lines, nlines, np, pool.stage(0), 0.0f, pool.stage(0), cfg.nu, nvals);
+            combine(lines, nlines, np, pool, 1, euler, dt, nvals);
+        }
+        if (cfg.outputEvery > 0 && step % cfg.outputEvery == 0) {
+            const double e = energy(lines, nlines, np);
+            if (step % (cfg.outputEvery * 10) == 0 || step == cfg.nsteps) {
+                printf("  %s step %7d  t = %8.3f  energy = %.6e\n", name, step, step * dt, e);
+            }
+        }
+        if (cfg.checkpointEvery > 0 && step % cfg.checkpointEvery == 0) {
+            auto c0 = std::chrono::steady_clock::now();
+            checkpoint(lines, nlines, np, ckpt);
+            tExposed += std::chrono::duration<double>(std::chrono::steady_clock::now() - c0).count();
+        }
+        hist.record(std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    }
+    const double tTotal = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+    stopTransferLog();
+    POP_RANGE
+
+    // Final state back to the host (outside the loop) and accuracy of the rotated line sums
+    checkpoint(lines, nlines, np, nullptr);
+    lineSums(lines, nlines, np, sums);
+    double err = 0.0, ref = 0.0;
+    for (int l = 0; l < nlines; ++l) {
+        const double th = (double)lines[l].getOmega() * cfg.nsteps * dt;
+        for (int k = 0; k < NFIELDS; k += 2) {
+            const double a = sums0[l * NFIELDS + k], b = sums0[l * NFIELDS + k + 1];
+            const double ea = a * std::cos(th) + b * std::sin(th), eb = -a * std::sin(th) + b * std::cos(th);
+            err = std::max(err, std::max(std::fabs(sums[l * NFIELDS + k] - ea), std::fabs(sums[l * NFIELDS + k + 1] - eb)));
+            ref = std::max(ref, std::max(std::fabs(a), std::fabs(b)));
+        }
+    }
+    if (ckpt) {
+        fclose(ckpt);
+    }
+
+    printf("%s: %d steps in %.3f s (%.1f us/step, %.1f us/step in checkpoints), line-sum error %.3e\n",
+           name, cfg.nsteps, tTotal, 1e6 * tTotal / cfg.nsteps, 1e6 * tExposed / cfg.nsteps, err / ref);
+    printf("%s: in-loop transfers: %ld to host (%.2f MB), %ld to device (%.2f MB); pool allocations: %ld\n",
+           name, log.toHostCount, 1e-6 * log.toHostBytes, log.toDeviceCount, 1e-6 * log.toDeviceBytes, pool.getAllocations());
+    hist.report(name);
+    printf("\n");
+}
+
+int main(int argc, const char** argv)
+{
+    int nlines = 256;
+    int np = 32;
+    RunConfig cfg = { 10000, 1e-3f, 0.2f, 100, 2500, nullptr };
+    for (int a = 1; a < argc; ++a) {
+        if (strcmp(argv[a], "--steps") == 0 && a + 1 < argc) {
+            cfg.nsteps = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--lines") == 0 && a + 1 < argc) {
+            nlines = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--dt") == 0 && a + 1 < argc) {
+            cfg.dt = (float)atof(argv[++a]);
+        } else if (strcmp(argv[a], "--output") == 0 && a + 1 < argc) {
+            cfg.outputEvery = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--checkpoint") == 0 && a + 1 < argc) {
+            cfg.checkpointEvery = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--checkpoint-file") == 0 && a + 1 < argc) {
+            cfg.checkpointFile = argv[++a];
+        }
+    }
+
+    // Lines and points are built and deep-copied once; everything after this stays resident
+    PUSH_RANGE("main::create", 2);
+    Line* lines = (Line*)calloc(nlines, sizeof(Line));
+    #pragma acc enter data copyin(lines[0:nlines])
+    for (int l = 0; l < nlines; ++l) {
+        lines[l].setLine(l, np, 1.0f + 0.01f * (l % 50));
+    }
+    POP_RANGE
+
+    printf("%d lines x %d points x %d fields, dt = %g, %d steps, output every %d, checkpoint every %d\n\n",
+           nlines, np, NFIELDS, cfg.dt, cfg.nsteps, cfg.outputEvery, cfg.checkpointEvery);
+    run("euler", false, lines, nlines, np, cfg);
+    run("rk4", true, lines, nlines, np, cfg);
+
+    return 0;
+}
@@ -0,0 +1,419 @@
+/**
+ * @file main.cxx
+ * @author Lucas Gasparino
+ * @brief Work-stealing host scheduler for Lines with heterogeneous point counts
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// C headers
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <pthread.h>
+
+// GPU headers
+#ifndef NOACC
+#include <cuda.h>
+#include <openacc.h>
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#ifndef NOACC
+// Macro utility for NVTX ranges
+const uint32_t colors[] = { 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffff0000, 0xffffffff };
+const int num_colors = sizeof(colors)/sizeof(uint32_t);
+
+// Push function for starting NVTX ranges
+#define PUSH_RANGE(name,cid) { \
+    int color_id = cid; \
+    color_id = color_id%num_colors;\
+    nvtxEventAttributes_t eventAttrib = {0}; \
+    eventAttrib.version = NVTX_VERSION; \
+    eventAttrib.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE; \
+    eventAttrib.colorType = NVTX_COLOR_ARGB; \
+    eventAttrib.color = colors[color_id]; \
+    eventAttrib.messageType = NVTX_MESSAGE_TYPE_ASCII; \
+    eventAttrib.message.ascii = name; \
+    nvtxRangePushEx(&eventAttrib); \
+}
+
+// Pop function for ending NVTX ranges
+#define POP_RANGE nvtxRangePop();
+#else
+// Host-only build: no NVTX available
+#define PUSH_RANGE(name,cid) {}
+#define POP_RANGE
+#endif
+
+// Point class containing an id and a dynamic float array (from array_of_objects)
+class Point
+{
+    private:
+        int pID;      // Unique identifier for the Point
+        int dataSize; // Size of the data array in elements
+        float* pData; // Data pointer as a dynamic array of floats
+    public:
+        int getDataSize() const { return dataSize; }
+        float* getData() const { return pData; }
+        void setPoint(int id, int n) {
+            this->pID = id;
+            this->dataSize = n;
+            this->pData = (float*)calloc(n, sizeof(float));
+        }
+};
+
+// Line class with its own number of points (mixed orders/refinement levels)
+class Line
+{
+    private:
+        int lID;       // Unique identifier for the Line
+        int nPoints;   // Number of Point objects in this Line
+        Point* points; // Pointer to an array of Point objects
+    public:
+        int getNPoints() const { return nPoints; }
+        Point* getPoints() const { return points; }
+        void setLine(int id, int firstPoint, int np, int ndata) {
+            this->lID = id;
+            this->nPoints = np;
+            this->points = (Point*)calloc(np, sizeof(Point));
+            for (int i = 0; i < np; ++i) {
+                points[i].setPoint(firstPoint + i, ndata);
+            }
+        }
+};
+
+// Half-open range of loop indices
+struct Range
+{
+    long begin;
+    long end;
+};
+
+// Per-worker deque: the owner works at the back, thieves take from the front
+struct WorkerQueue
+{
+    std::mutex mtx;
+    std::deque<Range> items;
+
+    void push(const Range& r) {
+        std::lock_guard<std::mutex> lock(mtx);
+        items.push_back(r);
+    }
+
+    bool pop(Range& r) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (items.empty()) {
+            return false;
+        }
+        r = items.back();
+        items.pop_back();
+        return true;
+    }
+
+    bool steal(Range& r) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (items.empty()) {
+            return false;
+        }
+        r = items.front();
+        items.pop_front();
+        return true;
+    }
+};
+
+/**
+ * @brief Thread pool running parallel_for with per-thread deques and random work stealing
+ *
+ * Ranges are split lazily: a worker keeps halving the range it owns, pushing the upper half
+ * back onto its deque (where idle workers can steal it), until it is below the grain size.
+ * Optional per-index cost hints set the initial partition so that every worker starts with
+ * the same estimated amount of work.
+ */
+class WorkStealingPool
+{
+    private:
+        int nthreads;                         // Workers, including the calling thread
+        std::vector<std::thread> workers;     // Threads 1..nthreads-1
+        std::vector<WorkerQueue> queues;      // One deque per worker
+        std::mutex jobMtx;                    // Protects the job hand-off
+        std::condition_variable jobCv;        // Wakes workers for a new job
+        long jobEpoch;                        // Incremented for every parallel_for
+        bool stop;                            // Shut the pool down
+        const std::function<void(long)>* body; // Current loop body
+        const std::function<void(int)>* task; // Current team task (run), replaces the loop body
+        long grain;                           // Current grain size
+        std::atomic<long> remaining;          // Indices left in the current job
+        std::atomic<long> steals;             // Successful steals (statistics)
+        std::atomic<int> busy;                // Workers still inside the current job
+
+        static void pinToCore(int core) {
+#ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(core % std::max(1u, std::thread::hardware_concurrency()), &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+        }
+
+        // Execute ranges until the job is complete
+        void work(int id) {
+            uint32_t rng = 2654435761u * (uint32_t)(id + 1);
+            Range r;
+            while (remaining.load(std::memory_order_acquire) > 0) {
+                bool got = queues[id].pop(r);
+                // Random victim selection (xorshift)
+                for (int attempt = 0; !got && attempt < 2 * nthreads; ++attempt) {
+                    rng ^= rng << 13;
+                    rng ^= rng >> 17;
+                    rng ^= rng << 5;
+                    const int victim = (int)(rng % (uint32_t)nthreads);
+                    if (victim != id && queues[victim].steal(r)) {
+                        got = true;
+                        steals.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                if (!got) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                // Lazy binary splitting: expose the upper half to thieves
+                while (r.end - r.begin > grain) {
+                    const long mid = r.begin + (r.end - r.begin) / 2;
+                    queues[id].push(Range{mid, r.end});
+                    r.end = mid;
+                }
+                for (long i = r.begin; i < r.end; ++i) {
+                    (*body)(i);
+                }
+                remaining.fetch_sub(r.end - r.begin, std::memory_order_acq_rel);
+            }
+        }
+
+        void workerLoop(int id, bool pin) {
+            if (pin) {
+                pinToCore(id);
+            }
+            long seen = 0;
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(jobMtx);
+                    jobCv.wait(lock, [&] { return stop || jobEpoch != seen; });
+                    if (stop) {
+                        return;
+                    }
+                    seen = jobEpoch;
+                }
+                if (task) {
+                    (*task)(id);
+                } else {
+                    work(id);
+                }
+                busy.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        }
+    public:
+        WorkStealingPool(int n, bool pin) : nthreads(std::max(1, n)), queues(std::max(1, n)), jobEpoch(0), stop(false),
+                                            body(nullptr), task(nullptr), grain(1), remaining(0), steals(0), busy(0) {
+            // Only the pool's own workers are pinned: the calling thread keeps its affinity mask,
+            // which every thread it creates later would otherwise inherit
+            for (int t = 1; t < nthreads; ++t) {
+                workers.emplace_back(&WorkStealingPool::workerLoop, this, t, pin);
+            }
+        }
+
+        ~WorkStealingPool() {
+            {
+                std::lock_guard<std::mutex> lock(jobMtx);
+                stop = true;
+            }
+            jobCv.notify_all();
+            for (auto& w : workers) {
+                w.join();
+            }
+        }
+
+        int size() const { return nthreads; }
+        long stealCount() const { return steals.load(); }
+
+        // Wake the workers for a new job, run the calling thread's share (id 0), then wait for the rest
+        void launch(const std::function<void()>& callerShare) {
+            busy.store(nthreads - 1, std::memory_order_release);
+            {
+                std::lock_guard<std::mutex> lock(jobMtx);
+                jobEpoch += 1;
+            }
+            jobCv.notify_all();
+            callerShare();
+            // Wait for the other workers to leave the job before body or task goes out of scope
+            while (busy.load(std::memory_order_acquire) > 0) {
+                std::this_thread::yield();
+            }
+        }
+
+        // Run t(id) once on every worker, like the threads of an OpenMP parallel region
+        void run(const std::function<void(int)>& t) {
+            task = &t;
+            launch([&] { t(0); });
+            task = nullptr;
+        }
+
+        // Run f(i) for i in [0, n). costs (optional) holds a relative cost estimate per index.
+        void parallel_for(long n, const std::function<void(long)>& f, const double* costs = nullptr, long grainSize = 1) {
+            if (n <= 0) {
+                return;
+            }
+            body = &f;
+            grain = std::max(1L, grainSize);
+            remaining.store(n, std::memory_order_relaxed);
+            // Initial partition: equal counts, or equal estimated cost when hints are given
+            double total = 0.0;
+            if (costs) {
+                for (long i = 0; i < n; ++i) {
+                    total += costs[i];
+                }
+            }
+            long begin = 0;
+            double acc = 0.0;
+            for (int t = 0; t < nthreads; ++t) {
+                long end = n;
+                if (t < nthreads - 1) {
+                    if (costs) {
+                        const double target = total * (t + 1) / nthreads;
+                        end = begin;
+                        // The item crossing the target stays in this range, so a heavy item never leaves a thread empty
+                        while (end < n && acc < target) {
+                            acc += costs[end++];
+                        }
+                    } else {
+                        end = n * (t + 1) / nthreads;
+                    }
+                }
+                if (end > begin) {
+                    queues[t].push(Range{begin, end});
+                }
+                begin = end;
+            }
+            launch([&] { work(0); });
+        }
+};
+
+// OpenMP-style static schedule: equal contiguous blocks of indices per thread
+// Runs on the pool's persistent workers, so only the schedule differs from work stealing
+void staticFor(WorkStealingPool& pool, long n, const std::function<void(long)>& f)
+{
+    const int nthreads = pool.size();
+    pool.run([&](int t) {
+        for (long i = n * t / nthreads; i < n * (t + 1) / nthreads; ++i) {
+            f(i);
+        }
+    });
+}
+
+// OpenMP-style dynamic schedule: chunks handed out from a shared counter
+void dynamicFor(WorkStealingPool& pool, long n, long chunk, const std::function<void(long)>& f)
+{
+    std::atomic<long> next(0);
+    pool.run([&](int) {
+        for (long start = next.fetch_add(chunk); start < n; start = next.fetch_add(chunk)) {
+            const long end = std::min(start + chunk, n);
+            for (long i = start; i < end; ++i) {
+                f(i);
+            }
+        }
+    });
+}
+
+int main(int argc, const char** argv)
+{
+    const int nthreads = (argc > 1) ? atoi(argv[1]) : (int)std::max(1u, std::thread::hardware_concurrency());
+    const int nlines = (argc > 2) ? atoi(argv[2]) : 4096; // Number of lines
+    const int ndata = 8;                                  // Data entries per point
+    const int nrep = 5;                                   // Timed repetitions per scheduler
+
+    // Skewed distribution of points per line: a few heavily refined lines, clustered at the start
+    // (as after a local refinement), so that a static split overloads the first thread
+    std::vector<int> np(nlines);
+    std::vector<double> cost(nlines);
+    uint64_t seed = 7;
+    long totalPoints = 0;
+    for (int i = 0; i < nlines; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        const double u = (double)(seed >> 11) / 9007199254740992.0;
+        const int refine = (i < nlines / 8) ? 6 : 0;
+        np[i] = (int)(4.0 / pow(1.0 - u, 0.7)) << refine; // Pareto-like tail
+        np[i] = std::min(np[i], 4096);
+        cost[i] = (double)np[i];
+        totalPoints += np[i];
+    }
+
+    PUSH_RANGE("main::initialize_lines", 0);
+    Line* lines = (Line*)calloc(nlines, sizeof(Line));
+    long first = 0;
+    for (int i = 0; i < nlines; ++i) {
+        lines[i].setLine(i, (int)first, np[i], ndata);
+        first += np[i];
+    }
+    POP_RANGE
+
+    // Per-line body: kernel_1 + kernel_2 of array_of_objects, cost proportional to the point count
+    std::function<void(long)> body = [&](long i) {
+        Point* points = lines[i].getPoints();
+        const int n = lines[i].getNPoints();
+        for (int j = 0; j < n; ++j) {
+            float* data = points[j].getData();
+            for (int k = 0; k < ndata; ++k) {
+                data[k] += static_cast<float>(1);
+                data[k] += static_cast<float>(i+j+k);
+            }
+        }
+    };
+
+    auto timeIt = [&](const char* label, const std::function<void()>& run) {
+        run(); // Warm-up
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < nrep; ++r) {
+            run();
+        }
+        const double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() / nrep;
+        printf("  %-32s %10.3f ms  %8.2f Mpoints/s\n", label, 1e3 * dt, totalPoints / dt * 1e-6);
+        return dt;
+    };
+
+    printf("%d lines, %ld points (min %d, max %d per line), %d threads\n", nlines, totalPoints,
+           *std::min_element(np.begin(), np.end()), *std::max_element(np.begin(), np.end()), nthreads);
+
+    WorkStealingPool pool(nthreads, true);
+    timeIt("static (equal blocks)", [&] { staticFor(pool, nlines, body); });
+    timeIt("dynamic (chunk 1)", [&] { dynamicFor(pool, nlines, 1, body); });
+    timeIt("dynamic (chunk 64)", [&] { dynamicFor(pool, nlines, 64, body); });
+    timeIt("work stealing (no hints)", [&] { pool.parallel_for(nlines, body, nullptr, 4); });
+    const long stealsBefore = pool.stealCount();
+    timeIt("work stealing (cost hints)", [&] { pool.parallel_for(nlines, body, cost.data(), 4); });
+    printf("  steals with cost hints: %.1f per run\n", (double)(pool.stealCount() - stealsBefore) / (nrep + 1));
+
+    // Sanity check: each of the 5 schedulers ran the body nrep+1 times on every line,
+    // so entry 0 of point 0 of line i must hold runs * (1 + i)
+    const float runs = 5.0f * (nrep + 1);
+    int mismatches = 0;
+    for (int i = 0; i < nlines; ++i) {
+        mismatches += (lines[i].getPoints()[0].getData()[0] != runs * (1.0f + static_cast<float>(i))) ? 1 : 0;
+    }
+    printf("Lines with inconsistent updates: %d\n", mismatches);
+
+    return 0;
+}